@@ -1,7 +1,17 @@
 #include <stdio.h>    // Standard input/output functions (for puts and perror)
 #include <stdlib.h>   // Standard library (for EXIT_SUCCESS and EXIT_FAILURE)
+#include <stdint.h>   // Fixed width integer types
+#include <unistd.h>   // POSIX API (for usleep)
 
 #include "rpi_gpio.h" // Raspberry Pi GPIO control library
+#include "mux_display.h" // Timer-driven multiplex refresh of the digits
+
+// Pointer to the Raspberry Pi's GPIO registers, set if they can be mapped into our address space.
+// When it is set, a digit is switched with single stores to the set and clear registers instead of GPIO messages.
+volatile uint32_t *rpi_gpio_regs;
+
+// Base address of the GPIO registers on the raspberry pi
+#define RPI_PERIPHERAL_BASE 0xfe000000
 
 // Define GPIO pins for each segment of the 7-segment display
 #define SEG_A GPIO23
@@ -19,93 +29,58 @@
 #define DIGIT_3 GPIO26
 #define DIGIT_4 GPIO25
 
-// Representation of digits (0-9) on the 7-segment display
-// Each row corresponds to a digit, and each column represents a segment (A-G, DP)
-int digits[10][8] = {
-    {1, 1, 1, 1, 1, 1, 0, 0},  // 0
-    {0, 1, 1, 0, 0, 0, 0, 0},  // 1
-    {1, 1, 0, 1, 1, 0, 1, 0},  // 2
-    {1, 1, 1, 1, 0, 0, 1, 0},  // 3
-    {0, 1, 1, 0, 0, 1, 1, 0},  // 4
-    {1, 0, 1, 1, 0, 1, 1, 0},  // 5
-    {1, 0, 1, 1, 1, 1, 1, 0},  // 6
-    {1, 1, 1, 0, 0, 0, 0, 0},  // 7
-    {1, 1, 1, 1, 1, 1, 1, 0},  // 8
-    {1, 1, 1, 1, 0, 1, 1, 0}   // 9
-};
-
-// Array of digit control pins (common anode display)
-int digit_pins[4] = {DIGIT_1, DIGIT_2, DIGIT_3, DIGIT_4};
-
-// Initialize a given GPIO pin as an output
-int init_gpio(int gpio_pin) {
-    if (rpi_gpio_setup(gpio_pin, GPIO_OUT)) {
-        perror("rpi_gpio_setup");
-        return -1;
-    }
-    return 0;
-}
-
-// Turn off all digit control lines (disable all digits)
-void clear_digits() {
-    for (int i = 0; i < 4; i++) {
-        rpi_gpio_output(digit_pins[i], GPIO_HIGH);  // Common anode: HIGH = OFF
-    }
-}
-
-// Display a single digit on a specified position
-void display_digit(int digit, int position) {
-    clear_digits(); // Turn off all digits before enabling a new one
-
-    // Get the segment pattern for the given digit
-    int *pattern = digits[digit];
-
-    // Set the segment states based on the pattern
-    rpi_gpio_output(SEG_A, pattern[0] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_B, pattern[1] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_C, pattern[2] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_D, pattern[3] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_E, pattern[4] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_F, pattern[5] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_G, pattern[6] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_DP, pattern[7] ? GPIO_HIGH : GPIO_LOW);
-
-    // Enable the specific digit position (LOW = ON for common anode)
-    rpi_gpio_output(digit_pins[position], GPIO_LOW);
-
-    usleep(1000); // Small delay to allow persistence of display
-}
+// Multiplexing: one digit is lit per timer tick, by a thread above the priority of ordinary threads (10)
+#define DIGIT_RATE_HZ 1000 // Each digit is lit for 1 ms, so the whole display refreshes at 250 Hz
+#define REFRESH_PRIORITY 30
+#define COUNT_INTERVAL_MS 40 // The counter advances every 40 ms
 
 // Display a 4-digit number on the 7-segment display
-void display_number(int num) {
+void display_number(mux_display_t *display, int num) {
     char num_str[5];
     snprintf(num_str, sizeof(num_str), "%04d", num); // Format number as 4-digit string
 
+    uint8_t segments[MUX_DISPLAY_DIGITS];
     for (int i = 0; i < 4; i++) {
-        int digit = num_str[i] - '0'; // Convert character to integer
-        display_digit(digit, i);
+        segments[i] = segment_glyph(num_str[i]); // Look up the segments of the character
     }
+
+    // One atomic update: the refresh thread never shows half of the new number
+    mux_display_set(display, segments);
 }
 
 int main() {
-    // Initialize all GPIO pins used for the segments and digit control
-    int all_pins[] = {SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G, SEG_DP,
-                       DIGIT_1, DIGIT_2, DIGIT_3, DIGIT_4};
+    // Map the GPIO registers if we are allowed to; otherwise every pin goes through the GPIO resource manager
+    if (!rpi_gpio_map_regs(RPI_PERIPHERAL_BASE)) {
+        printf("GPIO registers not mapped, using the GPIO resource manager\n");
+    }
 
-    for (int i = 0; i < 12; i++) {
-        if (init_gpio(all_pins[i]) == -1) {
-            return EXIT_FAILURE; // Exit if any GPIO setup fails
-        }
+    // GPIO pins used for the segments (lit when high) and digit control
+    mux_display_pins_t pins = {
+        .segments = {
+            .pins = {SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G, SEG_DP},
+            .active_low = false
+        },
+        .digits = {DIGIT_1, DIGIT_2, DIGIT_3, DIGIT_4}
+    };
+
+    // The refresh thread configures the pins and keeps the digits lit from now on
+    mux_display_t display;
+    if (mux_display_start(&display, &pins, DIGIT_RATE_HZ, REFRESH_PRIORITY) != MUX_DISPLAY_SUCCESS) {
+        fprintf(stderr, "Failed to start display refresh\n");
+        return EXIT_FAILURE;
     }
 
-    // Continuously display numbers from 0000 to 9999
+    // Continuously display numbers from 0000 to 9999; the main thread only updates the framebuffer
     while (1) {
         for (int num = 0; num < 10000; num++) { // Loop through numbers 0-9999
-            for (int i = 0; i < 10; i++) { // Multiplex each number for stability
-                display_number(num);
-            }
+            display_number(&display, num);
+            usleep(COUNT_INTERVAL_MS * 1000);
         }
+
+        printf("Digits refreshed: %llu, ticks missed: %llu\n",
+               (unsigned long long)atomic_load(&display.refreshes), (unsigned long long)atomic_load(&display.missed));
     }
 
+    mux_display_stop(&display);
     return EXIT_SUCCESS;
 }
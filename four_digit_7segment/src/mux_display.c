@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/neutrino.h>
+#include "mux_display.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Turn every digit and every segment off */
+static void blank(mux_display_t *display)
+{
+    for (unsigned i = 0; i < MUX_DISPLAY_DIGITS; i++)
+    {
+        segment_display_write_pin(&display->segments, display->pins.digits[i], true);
+    }
+    segment_display_show(&display->segments, 0);
+}
+
+static void *refresh_thread(void *arg)
+{
+    mux_display_t *display = arg;
+    const mux_display_pins_t *pins = &display->pins;
+    uint64_t ticks = 0;
+    unsigned digit = MUX_DISPLAY_DIGITS - 1;   // digit currently enabled
+
+    for (;;)
+    {
+        struct _pulse pulse;
+        if (MsgReceivePulse(display->chid, &pulse, sizeof(pulse), NULL) == -1)
+        {
+            perror("MsgReceivePulse");
+            break;
+        }
+        if (pulse.code == MUX_DISPLAY_PULSE_STOP)
+        {
+            break;
+        }
+
+        // Ticks are counted from the start time: pulses that queued up while the thread was held off
+        // are absorbed, and the ticks they stand for are counted as missed
+        uint64_t elapsed = (now_ns() - display->start_ns) / display->period_ns;
+        if (elapsed <= ticks)
+        {
+            continue;
+        }
+        if (elapsed > ticks + 1)
+        {
+            atomic_fetch_add(&display->missed, elapsed - ticks - 1);
+        }
+        ticks = elapsed;
+
+        unsigned next = (digit + 1) % MUX_DISPLAY_DIGITS;
+        uint8_t segments = (uint8_t)(atomic_load(&display->frame) >> (8 * next));
+
+        // Disable the digit before changing the segments, so they never show on the wrong one
+        segment_display_write_pin(&display->segments, pins->digits[digit], true);
+        segment_display_show(&display->segments, segments);
+        segment_display_write_pin(&display->segments, pins->digits[next], false);
+        digit = next;
+
+        atomic_fetch_add(&display->refreshes, 1);
+    }
+
+    blank(display);
+
+    return NULL;
+}
+
+/* Stop the thread, which blanks the display, and close the channel */
+static void stop_thread(mux_display_t *display)
+{
+    // The stop pulse is queued behind any refresh pulse still pending
+    MsgSendPulse(display->coid, display->priority, MUX_DISPLAY_PULSE_STOP, 0);
+    pthread_join(display->thread, NULL);
+
+    ConnectDetach(display->coid);
+    ChannelDestroy(display->chid);
+}
+
+int mux_display_start(mux_display_t *display, const mux_display_pins_t *pins, unsigned digit_rate_hz, int priority)
+{
+    if (display == NULL || pins == NULL || digit_rate_hz == 0)
+    {
+        return MUX_DISPLAY_ERROR_BAD_ARGUMENT;
+    }
+
+    memset(display, 0, sizeof(*display));
+    display->pins = *pins;
+    display->priority = priority;
+    display->period_ns = 1000000000ULL / digit_rate_hz;
+    atomic_init(&display->frame, 0);
+    atomic_init(&display->refreshes, 0);
+    atomic_init(&display->missed, 0);
+
+    if (segment_display_init(&display->segments, &pins->segments) != SEGMENT_DISPLAY_SUCCESS)
+    {
+        return MUX_DISPLAY_ERROR_GPIO;
+    }
+    for (unsigned i = 0; i < MUX_DISPLAY_DIGITS; i++)
+    {
+        if (segment_display_setup_pin(&display->segments, pins->digits[i]) != SEGMENT_DISPLAY_SUCCESS)
+        {
+            return MUX_DISPLAY_ERROR_GPIO;
+        }
+    }
+    blank(display);
+
+    display->chid = ChannelCreate(_NTO_CHF_PRIVATE);
+    if (display->chid == -1)
+    {
+        perror("ChannelCreate");
+        return MUX_DISPLAY_ERROR_SETUP_FAILED;
+    }
+
+    display->coid = ConnectAttach(ND_LOCAL_NODE, 0, display->chid, _NTO_SIDE_CHANNEL, 0);
+    if (display->coid == -1)
+    {
+        perror("ConnectAttach");
+        ChannelDestroy(display->chid);
+        return MUX_DISPLAY_ERROR_SETUP_FAILED;
+    }
+
+    // The thread runs at a fixed priority, and so do the pulses: a thread receiving a pulse takes on its priority
+    pthread_attr_t attr;
+    struct sched_param param = {.sched_priority = priority};
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+
+    int err = pthread_create(&display->thread, &attr, refresh_thread, display);
+    pthread_attr_destroy(&attr);
+    if (err != EOK)
+    {
+        errno = err;
+        perror("pthread_create");
+        ConnectDetach(display->coid);
+        ChannelDestroy(display->chid);
+        return MUX_DISPLAY_ERROR_THREAD;
+    }
+
+    struct sigevent event;
+    SIGEV_PULSE_INIT(&event, display->coid, priority, MUX_DISPLAY_PULSE_REFRESH, 0);
+
+    struct itimerspec period = {
+        .it_value = {.tv_sec = display->period_ns / 1000000000ULL, .tv_nsec = display->period_ns % 1000000000ULL},
+        .it_interval = {.tv_sec = display->period_ns / 1000000000ULL, .tv_nsec = display->period_ns % 1000000000ULL}};
+
+    if (timer_create(CLOCK_MONOTONIC, &event, &display->timer) == -1)
+    {
+        perror("timer_create");
+        stop_thread(display);
+        return MUX_DISPLAY_ERROR_SETUP_FAILED;
+    }
+
+    display->start_ns = now_ns();
+    if (timer_settime(display->timer, 0, &period, NULL) == -1)
+    {
+        perror("timer_settime");
+        mux_display_stop(display);
+        return MUX_DISPLAY_ERROR_SETUP_FAILED;
+    }
+
+    return MUX_DISPLAY_SUCCESS;
+}
+
+void mux_display_set(mux_display_t *display, const uint8_t segments[MUX_DISPLAY_DIGITS])
+{
+    unsigned frame = 0;
+    for (unsigned i = 0; i < MUX_DISPLAY_DIGITS; i++)
+    {
+        frame |= (unsigned)segments[i] << (8 * i);
+    }
+
+    atomic_store(&display->frame, frame);
+}
+
+void mux_display_stop(mux_display_t *display)
+{
+    timer_delete(display->timer);
+    stop_thread(display);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MUX_DISPLAY_H
+#define MUX_DISPLAY_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+#include "segment_display.h"
+
+/* Return codes for client API */
+#define MUX_DISPLAY_SUCCESS 0
+#define MUX_DISPLAY_ERROR_BAD_ARGUMENT -1
+#define MUX_DISPLAY_ERROR_GPIO -2
+#define MUX_DISPLAY_ERROR_SETUP_FAILED -3
+#define MUX_DISPLAY_ERROR_THREAD -4
+
+#define MUX_DISPLAY_DIGITS 4
+
+#define MUX_DISPLAY_PULSE_REFRESH 1
+#define MUX_DISPLAY_PULSE_STOP 2
+
+/* GPIO pins of a multiplexed display */
+typedef struct
+{
+    segment_pins_t segments;             // segment lines shared by the digits
+    int digits[MUX_DISPLAY_DIGITS];      // digit selects, leftmost first; driven low to enable (common anode)
+} mux_display_pins_t;
+
+/*
+ * Refresh engine of a multiplexed 7-segment display. A thread at a fixed
+ * SCHED_FIFO priority is woken by a periodic timer pulse and shows the next
+ * digit on every tick, so every digit is lit for the same time whatever the
+ * rest of the application does and the brightness stays steady.
+ *
+ * The framebuffer is one byte of SEGMENT_* bits per digit, packed into a
+ * single word: the application replaces it with one atomic store and the
+ * thread never shows half of an update. The segments are written through
+ * segment_display, with two register stores when the GPIO registers are
+ * mapped, otherwise only the pins that differ from the digit shown before.
+ */
+typedef struct
+{
+    mux_display_pins_t pins;
+    segment_display_t segments;  // owned by the refresh thread once it runs
+    atomic_uint frame;           // byte i holds the segments of digit i
+    int chid;
+    int coid;
+    timer_t timer;
+    int priority;
+    uint64_t period_ns;          // time each digit is lit
+    uint64_t start_ns;
+    pthread_t thread;
+
+    atomic_ullong refreshes;     // digits shown
+    atomic_ullong missed;        // ticks skipped because the thread woke up late
+} mux_display_t;
+
+/**
+ * Configure the pins as outputs, blank the display and start the refresh thread
+ *
+ * @param    display         display state (output)
+ * @param    pins            GPIO pins of the display (copied)
+ * @param    digit_rate_hz   digits shown per second; each digit is refreshed at a quarter of this rate
+ * @param    priority        SCHED_FIFO priority of the refresh thread and its timer pulse
+ *
+ * @returns  MUX_DISPLAY_SUCCESS             on success,
+ *           MUX_DISPLAY_ERROR_BAD_ARGUMENT  invalid pointer or zero rate
+ *           MUX_DISPLAY_ERROR_GPIO          a pin could not be configured
+ *           MUX_DISPLAY_ERROR_SETUP_FAILED  the channel or the timer could not be created
+ *           MUX_DISPLAY_ERROR_THREAD        the refresh thread could not be created
+ */
+int mux_display_start(mux_display_t *display, const mux_display_pins_t *pins, unsigned digit_rate_hz, int priority);
+
+/**
+ * Replace what the display shows; takes effect from the next digit refreshed
+ *
+ * @param    display     display state
+ * @param    segments    SEGMENT_* bits of each digit, leftmost first
+ */
+void mux_display_set(mux_display_t *display, const uint8_t segments[MUX_DISPLAY_DIGITS]);
+
+/**
+ * Stop the refresh thread and the timer and blank the display
+ *
+ * @param    display     display state
+ */
+void mux_display_stop(mux_display_t *display);
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SEGMENT_DISPLAY_H
+#define SEGMENT_DISPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Return codes for client API */
+#define SEGMENT_DISPLAY_SUCCESS 0
+#define SEGMENT_DISPLAY_ERROR_BAD_ARGUMENT -1
+#define SEGMENT_DISPLAY_ERROR_GPIO -2
+
+#define SEGMENT_COUNT 8         // A to G and the decimal point
+#define SEGMENT_PATTERNS 256    // every combination of the segments
+
+/* Segment bits of a glyph */
+#define SEGMENT_A  0x01
+#define SEGMENT_B  0x02
+#define SEGMENT_C  0x04
+#define SEGMENT_D  0x08
+#define SEGMENT_E  0x10
+#define SEGMENT_F  0x20
+#define SEGMENT_G  0x40
+#define SEGMENT_DP 0x80
+
+/* GPIO pins of the segments of a display, usually a compile-time constant */
+typedef struct
+{
+    int pins[SEGMENT_COUNT];  // segments A to G, then DP
+    bool active_low;          // segments light when their pin is low
+} segment_pins_t;
+
+/*
+ * A 7-segment display (or the shared segment lines of a multiplexed one)
+ * driven from GPIO pins. The pins to set and to clear for every segment
+ * pattern are computed once, when the display is initialized, so showing a
+ * glyph is a table lookup.
+ *
+ * If the GPIO registers are mapped (rpi_gpio_map_regs() succeeded before
+ * segment_display_init(), which needs the rights to map physical memory), a
+ * pattern is written with one GPSET0 and one GPCLR0 store. Otherwise the
+ * pins go through the GPIO resource manager, one message per segment that
+ * changed. An executable using this module defines rpi_gpio_regs, as for any
+ * user of the rpi_gpio register functions.
+ */
+typedef struct
+{
+    segment_pins_t pins;
+    bool direct;                                // patterns are written to the GPIO registers
+    int shown;                                  // pattern on the pins, -1 until the first one is written
+    uint32_t set_mask[SEGMENT_PATTERNS];        // pins driven high for each pattern
+    uint32_t clear_mask[SEGMENT_PATTERNS];      // pins driven low for each pattern
+} segment_display_t;
+
+/**
+ * Look up the segments of a character: hex digits, the letters that can be
+ * drawn on seven segments (in the case that can be drawn, e.g. 'b' for 'B'),
+ * space, '-', '_', '=' and '.'
+ *
+ * @param    c           character
+ *
+ * @returns  SEGMENT_* bits of the glyph, 0 (blank) if there is none
+ */
+uint8_t segment_glyph(char c);
+
+/**
+ * Configure the segment pins as outputs and precompute the register masks
+ * of every pattern. Nothing is shown until the first segment_display_show().
+ *
+ * @param    display     display state (output)
+ * @param    pins        segment pins (copied)
+ *
+ * @returns  SEGMENT_DISPLAY_SUCCESS             on success,
+ *           SEGMENT_DISPLAY_ERROR_BAD_ARGUMENT  invalid pointer or a pin above GPIO31
+ *           SEGMENT_DISPLAY_ERROR_GPIO          a pin could not be configured
+ */
+int segment_display_init(segment_display_t *display, const segment_pins_t *pins);
+
+/**
+ * Show a segment pattern
+ *
+ * @param    display     display state
+ * @param    segments    SEGMENT_* bits, e.g. from segment_glyph()
+ *
+ * @returns  SEGMENT_DISPLAY_SUCCESS             on success,
+ *           SEGMENT_DISPLAY_ERROR_GPIO          a pin could not be written
+ */
+int segment_display_show(segment_display_t *display, uint8_t segments);
+
+/**
+ * Configure another pin of the display (e.g. a digit select) as an output,
+ * the same way as the segments: through the registers if they are mapped,
+ * or the resource manager
+ *
+ * @param    display     display state
+ * @param    gpio        GPIO pin
+ *
+ * @returns  SEGMENT_DISPLAY_SUCCESS             on success,
+ *           SEGMENT_DISPLAY_ERROR_BAD_ARGUMENT  a pin above GPIO31
+ *           SEGMENT_DISPLAY_ERROR_GPIO          the pin could not be configured
+ */
+int segment_display_setup_pin(const segment_display_t *display, int gpio);
+
+/**
+ * Drive another pin of the display the same way as the segments
+ *
+ * @param    display     display state
+ * @param    gpio        GPIO pin, set up with segment_display_setup_pin()
+ * @param    high        level
+ *
+ * @returns  SEGMENT_DISPLAY_SUCCESS             on success,
+ *           SEGMENT_DISPLAY_ERROR_GPIO          the pin could not be written
+ */
+int segment_display_write_pin(const segment_display_t *display, int gpio, bool high);
+
+#endif
@@ -19,45 +19,21 @@
 #include <stdint.h>
 #include <stdbool.h>     // Needed for `bool`
 #include <signal.h>      // Needed for signal handling
-#include "rpi_spi.h"     // SPI interface header
+#include "mcp3008.h"     // MCP3008 ADC driver and scan engine
 
 // SPI bus and device configuration
 #define BUS 0
 #define DEVICE 0
 #define SPI_SPEED 1000000 // 1 MHz is sufficient for MCP3008
 
-// MCP3008 protocol constants
-#define MCP3008_START_BIT      0x01
-#define MCP3008_SGL_DIFF       0x08  // Single-ended mode
-#define MCP3008_DONT_CARE      0x00
+// Joystick axes on the MCP3008 and how often they are scanned
+#define CHANNEL_X 0
+#define CHANNEL_Y 1
+#define SCAN_RATE_HZ 1000
 
 // Flag to control main loop execution
 bool running = true;
 
-// Read 10-bit analog data from the specified MCP3008 channel
-int mcp3008_read_channel(uint8_t channel, uint16_t *result) {
-    if (channel > 7 || result == NULL) return 0;
-
-    uint8_t write_buffer[3];
-
-    // Prepare SPI message: start bit, single-ended + channel, and dummy byte
-    write_buffer[0] = MCP3008_START_BIT;                    // Start bit
-    write_buffer[1] = (MCP3008_SGL_DIFF | channel) << 4;    // Channel in bits 6-4
-    write_buffer[2] = MCP3008_DONT_CARE;                    // Don't care byte
-
-    uint8_t read_buffer[3] = {0};
-
-    // Perform SPI transaction
-    if (rpi_spi_write_read_data(BUS, DEVICE, write_buffer, read_buffer, 3) != SPI_SUCCESS) {
-        fprintf(stderr, "SPI read failed\n");
-        return 0;
-    }
-
-    // Extract 10-bit result from returned bytes
-    *result = ((read_buffer[1] & 0x03) << 8) | read_buffer[2];
-    return 1;
-}
-
 // Signal handler to exit the main loop gracefully
 static void ctrl_c_handler(int signum) {
     (void)(signum);     // Avoid unused parameter warning
@@ -79,27 +55,44 @@ int main() {
     setup_handlers();
 
     // Configure SPI interface for MCP3008
-    if (rpi_spi_configure_device(BUS, DEVICE,
-        SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0,
-        SPI_SPEED) != SPI_SUCCESS) {
+    mcp3008_t adc;
+    if (mcp3008_init(&adc, BUS, DEVICE, SPI_SPEED) != MCP3008_SUCCESS) {
         fprintf(stderr, "Failed to configure SPI\n");
         return 1;
     }
 
-    // Main loop: read joystick values continuously until stopped
-    while (running) {
-        uint16_t x = 0, y = 0;
+    // Stream both axes from the scan thread instead of polling the ADC
+    static mcp3008_scan_t scan;
+    if (mcp3008_scan_start(&scan, &adc, (1 << CHANNEL_X) | (1 << CHANNEL_Y), SCAN_RATE_HZ) != MCP3008_SUCCESS) {
+        fprintf(stderr, "Failed to start ADC scan\n");
+        return 1;
+    }
 
-        // Read X and Y channels (0 and 1)
-        if (mcp3008_read_channel(0, &x) && mcp3008_read_channel(1, &y)) {
-            printf("Joystick X: %4d, Y: %4d\n", x, y);
-        } else {
-            fprintf(stderr, "Failed to read joystick\n");
+    // Main loop: every 100ms, drain the samples scanned since the last pass and print their average
+    while (running) {
+        static mcp3008_sample_t samples[MCP3008_RING_SIZE];
+        unsigned count = mcp3008_scan_read(&scan, samples, MCP3008_RING_SIZE);
+
+        if (count > 0) {
+            uint32_t x = 0, y = 0;
+            for (unsigned i = 0; i < count; i++) {
+                x += samples[i].value[CHANNEL_X];
+                y += samples[i].value[CHANNEL_Y];
+            }
+            printf("Joystick X: %4u, Y: %4u (%u samples)\n", x / count, y / count, count);
         }
 
         usleep(100000); // Delay 100ms between reads
     }
 
+    mcp3008_scan_stop(&scan);
+
+    mcp3008_scan_stats_t stats;
+    mcp3008_scan_get_stats(&scan, &stats);
+    printf("Scans: %llu, dropped: %llu, overruns: %llu, errors: %llu\n",
+           (unsigned long long)stats.scans, (unsigned long long)stats.dropped,
+           (unsigned long long)stats.overruns, (unsigned long long)stats.errors);
+
     // Clean up SPI device before exiting
     rpi_spi_cleanup_device(BUS, DEVICE);
 
@@ -19,6 +19,9 @@
 #define RPI_SPI_API_H
  
 #include <hw/io-spi.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 // SPI GPIO pins for RaspBerry PI 4 / 5
 #define SPI0_CE0 8
@@ -44,6 +47,93 @@
 #define SPI_ERROR_BAD_ARGUMENT -2
 #define SPI_ERROR_OPERATION_FAILED -3
 
+/* Bus arbitration classes, lowest to highest priority */
+typedef enum
+{
+    SPI_PRIORITY_BULK,       // long transfers that can wait, e.g. display refreshes
+    SPI_PRIORITY_NORMAL,     // default
+    SPI_PRIORITY_REALTIME,   // short latency-critical transfers, e.g. input sampling
+    SPI_PRIORITY_COUNT
+} rpi_spi_priority_t;
+
+/* Request-to-completion latency of the exchanges of one priority class */
+typedef struct
+{
+    uint64_t count;          // exchanges measured
+    uint64_t p50_ns;         // median
+    uint64_t p90_ns;         // 90th percentile
+    uint64_t p99_ns;         // 99th percentile
+    uint64_t max_ns;         // worst case
+} rpi_spi_latency_stats_t;
+
+/* Configuration cache counters of a device */
+typedef struct
+{
+    uint64_t requests;       // configurations requested
+    uint64_t set_configs;    // DCMD_SPI_SET_CONFIG messages sent to the driver
+} rpi_spi_config_stats_t;
+
+/* Transfer list segment flags */
+#define SPI_SEGMENT_CS_DEASSERT 0x01 // release chip select after this segment
+
+#define RPI_SPI_MAX_SEGMENTS 16 // segments per exchange, i.e. between two CS deasserts
+
+/* One segment of a transfer list */
+typedef struct
+{
+    const uint8_t *tx;   // data to write
+    uint8_t *rx;         // buffer for the data read, NULL if not required
+    uint32_t len;        // number of bytes in both buffers
+    uint32_t flags;      // SPI_SEGMENT_* flags
+} rpi_spi_segment_t;
+
+/* Transfers of at least this many bytes use DMA by default, if the driver supports it */
+#define RPI_SPI_DMA_THRESHOLD_DEFAULT 256
+#define RPI_SPI_DMA_NEVER UINT32_MAX
+
+/*
+ * A physically contiguous, uncached pair of transfer buffers that io-spi can
+ * use for DMA. Allocated once with rpi_spi_dma_alloc() and owned by the caller.
+ */
+typedef struct
+{
+    uint8_t *tx;             // data to write
+    uint8_t *rx;             // data read
+    uint32_t size;           // size of each buffer in bytes
+    uint64_t tx_paddr;       // physical address of tx
+    uint64_t rx_paddr;       // physical address of rx
+} rpi_spi_dma_buffer_t;
+
+typedef struct rpi_spi_request rpi_spi_request_t;
+
+/* Completion callback of an asynchronous request, called from the bus worker thread */
+typedef void (*rpi_spi_callback_t)(rpi_spi_request_t *request, void *arg);
+
+/*
+ * An asynchronous transfer list. The request and the buffers its segments
+ * point to belong to the caller and must not be changed until it completes.
+ * A request must be zero-initialized (e.g. with a designated initializer)
+ * before its first submission: its private fields tell whether it is pending.
+ */
+struct rpi_spi_request
+{
+    unsigned device_number;              // SPI device number
+    const rpi_spi_segment_t *segments;   // segments, as for rpi_spi_transfer_list()
+    unsigned segment_count;              // number of segments
+    rpi_spi_callback_t callback;         // called on completion, NULL if not required
+    void *callback_arg;                  // user argument passed to the callback
+    struct sigevent event;               // SIGEV_PULSE sent on completion, SIGEV_NONE (zero) if not required
+    int result;                          // SPI_SUCCESS or SPI_ERROR_* once complete (output)
+
+    // Private to the SPI library
+    unsigned bus_number;
+    bool busy;
+    rpi_spi_request_t *next;
+};
+
+/* Size of a buffer holding an exchange header and data_size bytes of data, for rpi_spi_exchange() */
+#define RPI_SPI_XCHNG_SIZE(data_size) (sizeof(spi_xchng_t) + (data_size))
+
 /**
  * Query the SPI driver
  *
@@ -73,7 +163,8 @@ int rpi_spi_get_driver_info(unsigned bus_number, unsigned device_number, spi_drv
 int rpi_spi_get_device_info(unsigned bus_number, unsigned device_number, spi_devinfo_t *device_info);
 
 /**
- * Configure the SPI device
+ * Configure the SPI device. The configuration is only sent to the driver if it
+ * differs from the one last applied to the device.
  *
  * @param    bus_number          SPI bus number
  * @param    device_number       SPI device number
@@ -87,7 +178,37 @@ int rpi_spi_get_device_info(unsigned bus_number, unsigned device_number, spi_dev
 int rpi_spi_configure_device(unsigned bus_number, unsigned device_number, unsigned mode, uint32_t spi_device_speed_hz);
 
 /**
- * Write/read data to/from the SPI interface
+ * Request a configuration for a device without sending it. The configuration
+ * is sent before the device's next exchange, and only if it differs from the
+ * one last applied, so devices can state their configuration before every
+ * transfer at no cost.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    mode                SPI device mode
+ * @param    spi_device_speed_hz SPI device speed in Hz
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_BAD_ARGUMENT     invalid bus or device
+ */
+int rpi_spi_set_config(unsigned bus_number, unsigned device_number, unsigned mode, uint32_t spi_device_speed_hz);
+
+/**
+ * Read how many configurations were requested for a device and how many of
+ * them had to be sent to the driver
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    stats               configuration counters (output)
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_BAD_ARGUMENT     invalid bus, device or stats pointer
+ */
+int rpi_spi_get_config_stats(unsigned bus_number, unsigned device_number, rpi_spi_config_stats_t *stats);
+
+/**
+ * Write/read data to/from the SPI interface. The buffers are passed to the
+ * driver directly (no allocation or copy).
  *
  * @param    bus_number          SPI bus number
  * @param    device_number       SPI device number
@@ -104,6 +225,178 @@ int rpi_spi_write_read_data(unsigned bus_number, unsigned device_number,
                             uint8_t *read_data_buffer,
                             uint32_t data_size);
 
+/**
+ * Write/read data to/from the SPI interface in place, using a caller provided
+ * buffer of RPI_SPI_XCHNG_SIZE(data_size) bytes. The data to write is placed in
+ * xchng->data and replaced by the data read.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    xchng               exchange header followed by the data
+ * @param    data_size           number of data bytes to exchange
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_NOT_CONNECTED    if the SPI device is not available to connect to
+ *           SPI_ERROR_BAD_ARGUMENT     invalid buffer pointer or data size
+ *           SPI_ERROR_OPERATION_FAILED SPI operation failed
+ */
+int rpi_spi_exchange(unsigned bus_number, unsigned device_number, spi_xchng_t *xchng, uint32_t data_size);
+
+/**
+ * Execute a list of segments with a single call. Consecutive segments are
+ * clocked out back to back with chip select held asserted; CS is released
+ * after a segment flagged SPI_SEGMENT_CS_DEASSERT and after the last one.
+ * io-spi drives CS once per exchange, so each CS release costs one devctl.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    segments            segments to execute in order
+ * @param    segment_count       number of segments
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_NOT_CONNECTED    if the SPI device is not available to connect to
+ *           SPI_ERROR_BAD_ARGUMENT     empty list, segment without data, more than
+ *                                      RPI_SPI_MAX_SEGMENTS segments between CS releases, or
+ *                                      more write-only data ahead of a read buffer of the same
+ *                                      run than can be skipped (about 8 KB); nothing is sent
+ *           SPI_ERROR_OPERATION_FAILED SPI operation failed
+ */
+int rpi_spi_transfer_list(unsigned bus_number, unsigned device_number,
+                          const rpi_spi_segment_t *segments,
+                          unsigned segment_count);
+
+/**
+ * Allocate a pair of physically contiguous transfer buffers
+ *
+ * @param    buffer              buffer description (output)
+ * @param    size                size of each buffer in bytes
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_BAD_ARGUMENT     invalid buffer pointer or zero size
+ *           SPI_ERROR_OPERATION_FAILED the memory could not be allocated
+ */
+int rpi_spi_dma_alloc(rpi_spi_dma_buffer_t *buffer, uint32_t size);
+
+/**
+ * Free buffers allocated with rpi_spi_dma_alloc()
+ *
+ * @param    buffer              buffer description
+ */
+void rpi_spi_dma_free(rpi_spi_dma_buffer_t *buffer);
+
+/**
+ * Set the size from which rpi_spi_transfer() uses DMA for a device. Use 0 to
+ * always use DMA and RPI_SPI_DMA_NEVER to never use it. The default is
+ * RPI_SPI_DMA_THRESHOLD_DEFAULT.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    threshold           smallest transfer, in bytes, sent with DMA
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_BAD_ARGUMENT     invalid bus or device
+ */
+int rpi_spi_set_dma_threshold(unsigned bus_number, unsigned device_number, uint32_t threshold);
+
+/**
+ * Exchange the first data_size bytes of a DMA buffer pair: buffer->tx is
+ * written and buffer->rx receives the data read. Transfers below the device's
+ * DMA threshold, or on a driver without DMA support, are sent with
+ * DCMD_SPI_DATA_XCHNG from the same buffers instead.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    buffer              buffers allocated with rpi_spi_dma_alloc()
+ * @param    data_size           number of bytes to exchange
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_NOT_CONNECTED    if the SPI device is not available to connect to
+ *           SPI_ERROR_BAD_ARGUMENT     invalid buffer, or data size zero or larger than the buffer
+ *           SPI_ERROR_OPERATION_FAILED SPI operation failed
+ */
+int rpi_spi_transfer(unsigned bus_number, unsigned device_number, rpi_spi_dma_buffer_t *buffer, uint32_t data_size);
+
+/**
+ * Queue a transfer list for asynchronous execution and return at once. The
+ * requests of a bus are executed back to back, in submission order, by a
+ * worker thread that is started on the first submission and runs until the
+ * process exits; they take part in the bus arbitration like any exchange.
+ *
+ * On completion the result is stored in request->result, then the callback is
+ * called from the worker thread, then waiters are released and finally the
+ * pulse in request->event is sent. The callback must not block and must not
+ * resubmit the request; once the pulse arrives the request may be reused.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    request             request to execute
+ *
+ * @returns  SPI_SUCCESS                request queued,
+ *           SPI_ERROR_NOT_CONNECTED    if the SPI device is not available to connect to
+ *           SPI_ERROR_BAD_ARGUMENT     invalid bus or segment list, or the request is still pending
+ *           SPI_ERROR_OPERATION_FAILED the bus worker could not be started
+ */
+int rpi_spi_submit(unsigned bus_number, rpi_spi_request_t *request);
+
+/**
+ * Wait for a submitted request to complete
+ *
+ * @param    request             submitted request
+ *
+ * @returns  the result of the request (SPI_SUCCESS or SPI_ERROR_*),
+ *           SPI_ERROR_BAD_ARGUMENT     if the request is NULL or holds an invalid bus
+ *                                      (it was not zero-initialized)
+ */
+int rpi_spi_wait(rpi_spi_request_t *request);
+
+/**
+ * Check whether a submitted request has completed, without blocking
+ *
+ * @param    request             submitted request
+ *
+ * @returns  true once the request has completed, or if it is NULL or holds an invalid bus
+ */
+bool rpi_spi_is_complete(rpi_spi_request_t *request);
+
+/**
+ * Set the arbitration class of a device. Exchanges of the threads of this
+ * process on the same bus are run one at a time, highest class first and in
+ * request order within a class; a transfer list is arbitrated per CS run.
+ * Devices are SPI_PRIORITY_NORMAL by default.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    device_number       SPI device number
+ * @param    priority            arbitration class of the device's exchanges
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_BAD_ARGUMENT     invalid bus, device or priority
+ */
+int rpi_spi_set_priority(unsigned bus_number, unsigned device_number, rpi_spi_priority_t priority);
+
+/**
+ * Read the latency percentiles of a priority class on a bus. The latency is
+ * measured from the request to the completion of each exchange, so it includes
+ * the time spent waiting for the bus. Percentiles are resolved to 1/8 of a
+ * power of two.
+ *
+ * @param    bus_number          SPI bus number
+ * @param    priority            priority class
+ * @param    stats               latency statistics (output)
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_BAD_ARGUMENT     invalid bus, priority or stats pointer
+ */
+int rpi_spi_get_latency_stats(unsigned bus_number, rpi_spi_priority_t priority, rpi_spi_latency_stats_t *stats);
+
+/**
+ * Clear the latency statistics of all priority classes on a bus
+ *
+ * @param    bus_number          SPI bus number
+ *
+ * @returns  SPI_SUCCESS                on success,
+ *           SPI_ERROR_BAD_ARGUMENT     invalid bus
+ */
+int rpi_spi_reset_latency_stats(unsigned bus_number);
+
 /**
  * Cleanup from using the SPI device
  *
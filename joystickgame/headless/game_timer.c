@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Host stand-in for the game timer: the same tick counting, driven by
+ * absolute clock_nanosleep() deadlines instead of a timer pulse. The timer
+ * stops when the replayed joystick trace is over.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "game_timer.h"
+#include "spi_standin.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int game_timer_start(game_timer_t *timer, uint64_t period_ns)
+{
+    if (timer == NULL || period_ns == 0)
+    {
+        return GAME_TIMER_ERROR_BAD_ARGUMENT;
+    }
+
+    memset(timer, 0, sizeof(*timer));
+    timer->period_ns = period_ns;
+    timer->start_ns = now_ns();
+
+    return GAME_TIMER_SUCCESS;
+}
+
+int game_timer_wait(game_timer_t *timer)
+{
+    if (standin_trace_finished())
+    {
+        return GAME_TIMER_STOPPED;
+    }
+
+    uint64_t elapsed = (now_ns() - timer->start_ns) / timer->period_ns;
+    if (elapsed <= timer->ticks)
+    {
+        uint64_t deadline_ns = timer->start_ns + (timer->ticks + 1) * timer->period_ns;
+        struct timespec deadline = {
+            .tv_sec = deadline_ns / 1000000000ULL,
+            .tv_nsec = deadline_ns % 1000000000ULL};
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+        {
+        }
+        elapsed = (now_ns() - timer->start_ns) / timer->period_ns;
+    }
+
+    int due = (int)(elapsed - timer->ticks);
+    timer->ticks = elapsed;
+    return due;
+}
+
+void game_timer_stop(game_timer_t *timer)
+{
+}
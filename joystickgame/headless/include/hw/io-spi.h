@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Host stand-in for the parts of the QNX io-spi interface used by the
+ * rpi_spi.h declarations, so the game builds without the QNX headers.
+ */
+
+#ifndef HEADLESS_IO_SPI_H
+#define HEADLESS_IO_SPI_H
+
+#include <stdint.h>
+
+#define SPI_MODE_WORD_WIDTH_8 8
+#define SPI_MODE_BODER_MSB    (1 << 10)
+#define SPI_MODE_CPHA_0       0
+
+typedef struct
+{
+    uint32_t mode;
+    uint32_t clock_rate;
+} spi_cfg_t;
+
+typedef struct
+{
+    uint32_t version;
+    char name[16];
+    uint32_t feature;
+} spi_drvinfo_t;
+
+typedef struct
+{
+    uint32_t device;
+    char name[16];
+    spi_cfg_t cfg;
+} spi_devinfo_t;
+
+typedef struct
+{
+    uint32_t nbytes;
+    uint8_t data[];
+} spi_xchng_t;
+
+#endif
@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "rpi_spi.h"
+#include "spi_standin.h"
+
+#define STANDIN_MAX_BUSES 6
+#define STANDIN_MAX_DEVICES 10
+
+#define MCP3008_START_BIT 0x01
+#define MAX7219_REG_NOOP 0x00
+#define MAX7219_REG_DIGIT0 0x01
+#define MAX7219_ROWS 8
+
+typedef enum
+{
+    STANDIN_NONE,
+    STANDIN_MCP3008,
+    STANDIN_MAX7219
+} standin_kind_t;
+
+/* Counters of one emulated device */
+typedef struct
+{
+    standin_kind_t kind;
+    uint64_t exchanges;      // CS runs
+    uint64_t bytes;
+    uint64_t conversions;    // MCP3008: conversions requested
+    uint64_t row_writes;     // MAX7219: digit register writes
+    uint64_t noops;          // MAX7219: no-op register writes
+    uint64_t control_writes; // MAX7219: other register writes
+    uint64_t flushes;        // MAX7219: transfer lists and submitted requests
+    unsigned modules;        // MAX7219: modules in the chain
+    uint8_t rows[MAX7219_ROWS][STANDIN_MAX_MODULES]; // MAX7219: module 0 is the last in the chain
+} standin_device_t;
+
+typedef struct
+{
+    uint64_t t_ns;
+    uint16_t x;
+    uint16_t y;
+} trace_point_t;
+
+static standin_device_t standin_devices[STANDIN_MAX_BUSES][STANDIN_MAX_DEVICES];
+static trace_point_t standin_trace[STANDIN_MAX_TRACE_POINTS];
+static unsigned standin_trace_count;
+static uint64_t standin_start_ns;
+static FILE *standin_capture;
+
+// The scan thread and the game thread exchange concurrently
+static pthread_mutex_t standin_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int standin_load_trace(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return STANDIN_ERROR_FILE;
+    }
+
+    char line[128];
+    unsigned count = 0;
+    int result = STANDIN_SUCCESS;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        unsigned long long t_ms;
+        unsigned x, y;
+
+        if (line[0] == '#' || sscanf(line, "%llu %u %u", &t_ms, &x, &y) != 3)
+        {
+            continue;
+        }
+        if (count >= STANDIN_MAX_TRACE_POINTS)
+        {
+            result = STANDIN_ERROR_FILE;
+            break;
+        }
+
+        standin_trace[count++] = (trace_point_t){
+            .t_ns = t_ms * 1000000ULL,
+            .x = x > 1023 ? 1023 : x,
+            .y = y > 1023 ? 1023 : y};
+    }
+    fclose(file);
+
+    if (count == 0)
+    {
+        result = STANDIN_ERROR_FILE;
+    }
+
+    pthread_mutex_lock(&standin_mutex);
+    standin_trace_count = result == STANDIN_SUCCESS ? count : 0;
+    standin_start_ns = now_ns();
+    pthread_mutex_unlock(&standin_mutex);
+
+    return result;
+}
+
+int standin_capture_open(const char *path)
+{
+    standin_capture = fopen(path, "w");
+    if (standin_capture == NULL)
+    {
+        perror(path);
+        return STANDIN_ERROR_FILE;
+    }
+
+    fprintf(standin_capture, "# time_ms row0 .. row7 (modules left to right, bit 7 is the leftmost column)\n");
+    return STANDIN_SUCCESS;
+}
+
+static int attach(unsigned bus, unsigned device, standin_kind_t kind, unsigned modules)
+{
+    if (bus >= STANDIN_MAX_BUSES || device >= STANDIN_MAX_DEVICES)
+    {
+        return STANDIN_ERROR_BAD_ARGUMENT;
+    }
+
+    pthread_mutex_lock(&standin_mutex);
+    memset(&standin_devices[bus][device], 0, sizeof(standin_device_t));
+    standin_devices[bus][device].kind = kind;
+    standin_devices[bus][device].modules = modules;
+    pthread_mutex_unlock(&standin_mutex);
+
+    return STANDIN_SUCCESS;
+}
+
+int standin_attach_mcp3008(unsigned bus, unsigned device)
+{
+    return attach(bus, device, STANDIN_MCP3008, 0);
+}
+
+int standin_attach_max7219(unsigned bus, unsigned device, unsigned modules)
+{
+    if (modules < 1 || modules > STANDIN_MAX_MODULES)
+    {
+        return STANDIN_ERROR_BAD_ARGUMENT;
+    }
+
+    return attach(bus, device, STANDIN_MAX7219, modules);
+}
+
+bool standin_trace_finished(void)
+{
+    pthread_mutex_lock(&standin_mutex);
+    bool finished = standin_trace_count == 0 ||
+                    now_ns() - standin_start_ns > standin_trace[standin_trace_count - 1].t_ns;
+    pthread_mutex_unlock(&standin_mutex);
+
+    return finished;
+}
+
+/* Trace position at the current time; the center before the first point */
+static const trace_point_t *trace_position(void)
+{
+    static const trace_point_t center = {.x = 512, .y = 512};
+    const trace_point_t *position = &center;
+    uint64_t t = now_ns() - standin_start_ns;
+
+    for (unsigned i = 0; i < standin_trace_count && standin_trace[i].t_ns <= t; i++)
+    {
+        position = &standin_trace[i];
+    }
+
+    return position;
+}
+
+/* MCP3008: a conversion is the start bit, then the mode and channel, then the 10-bit result is clocked out */
+static void mcp3008_exchange(standin_device_t *dev, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    for (uint32_t i = 0; i + 3 <= len; i += 3)
+    {
+        if (tx[i] != MCP3008_START_BIT)
+        {
+            continue;
+        }
+
+        unsigned channel = (tx[i + 1] >> 4) & 0x07;
+        const trace_point_t *position = trace_position();
+        uint16_t value = channel == 0 ? position->x : channel == 1 ? position->y : 0;
+
+        if (rx != NULL)
+        {
+            rx[i] = 0;
+            rx[i + 1] = (value >> 8) & 0x03;
+            rx[i + 2] = value & 0xFF;
+        }
+        dev->conversions++;
+    }
+}
+
+/*
+ * MAX7219: register writes are (register, value) pairs shifted through the chain and latched when CS rises.
+ * The last pair of the run stays in the first device of the chain (the rightmost module), the pair before it
+ * in the next one, and pairs shifted out of the end of the chain are lost.
+ */
+static bool max7219_exchange(standin_device_t *dev, const uint8_t *tx, uint32_t len)
+{
+    bool changed = false;
+    uint32_t pairs = len / 2;
+    uint32_t first = pairs > dev->modules ? pairs - dev->modules : 0;
+
+    for (uint32_t pair = first; pair < pairs; pair++)
+    {
+        uint32_t i = 2 * pair;
+        unsigned module = dev->modules - (pairs - pair);
+        uint8_t reg = tx[i];
+
+        if (reg == MAX7219_REG_NOOP)
+        {
+            dev->noops++;
+        }
+        else if (reg >= MAX7219_REG_DIGIT0 && reg < MAX7219_REG_DIGIT0 + MAX7219_ROWS)
+        {
+            changed |= dev->rows[reg - MAX7219_REG_DIGIT0][module] != tx[i + 1];
+            dev->rows[reg - MAX7219_REG_DIGIT0][module] = tx[i + 1];
+            dev->row_writes++;
+        }
+        else
+        {
+            dev->control_writes++;
+        }
+    }
+
+    return changed;
+}
+
+/* One CS run on an emulated device; returns true if a matrix changed */
+static bool exchange(unsigned bus, unsigned device, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    standin_device_t *dev = &standin_devices[bus][device];
+
+    dev->exchanges++;
+    dev->bytes += len;
+
+    if (rx != NULL)
+    {
+        memset(rx, 0, len);
+    }
+
+    switch (dev->kind)
+    {
+    case STANDIN_MCP3008:
+        mcp3008_exchange(dev, tx, rx, len);
+        return false;
+    case STANDIN_MAX7219:
+        return max7219_exchange(dev, tx, len);
+    default:
+        return false;
+    }
+}
+
+static void capture_frame(standin_device_t *dev)
+{
+    if (standin_capture == NULL)
+    {
+        return;
+    }
+
+    fprintf(standin_capture, "%llu", (unsigned long long)((now_ns() - standin_start_ns) / 1000000ULL));
+    for (unsigned row = 0; row < MAX7219_ROWS; row++)
+    {
+        fprintf(standin_capture, " ");
+        for (unsigned module = 0; module < dev->modules; module++)
+        {
+            fprintf(standin_capture, "%02x", dev->rows[row][module]);
+        }
+    }
+    fprintf(standin_capture, "\n");
+}
+
+static bool valid_device(unsigned bus, unsigned device)
+{
+    return bus < STANDIN_MAX_BUSES && device < STANDIN_MAX_DEVICES;
+}
+
+int rpi_spi_configure_device(unsigned bus_number, unsigned device_number, unsigned mode, uint32_t spi_device_speed_hz)
+{
+    return valid_device(bus_number, device_number) ? SPI_SUCCESS : SPI_ERROR_NOT_CONNECTED;
+}
+
+int rpi_spi_write_read_data(unsigned bus_number, unsigned device_number,
+                            uint8_t *write_data_buffer,
+                            uint8_t *read_data_buffer,
+                            uint32_t data_size)
+{
+    if (!valid_device(bus_number, device_number))
+    {
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+    if (write_data_buffer == NULL || data_size < 1)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    pthread_mutex_lock(&standin_mutex);
+    exchange(bus_number, device_number, write_data_buffer, read_data_buffer, data_size);
+    pthread_mutex_unlock(&standin_mutex);
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_transfer_list(unsigned bus_number, unsigned device_number,
+                          const rpi_spi_segment_t *segments,
+                          unsigned segment_count)
+{
+    if (!valid_device(bus_number, device_number))
+    {
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+    if (segments == NULL || segment_count < 1)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    standin_device_t *dev = &standin_devices[bus_number][device_number];
+    bool changed = false;
+
+    // Segments joined without a CS release are decoded on their own; the emulated devices
+    // only use runs of whole commands, so this does not change the result
+    pthread_mutex_lock(&standin_mutex);
+    for (unsigned i = 0; i < segment_count; i++)
+    {
+        changed |= exchange(bus_number, device_number, segments[i].tx, segments[i].rx, segments[i].len);
+    }
+
+    if (dev->kind == STANDIN_MAX7219)
+    {
+        dev->flushes++;
+        if (changed)
+        {
+            capture_frame(dev);
+        }
+    }
+    pthread_mutex_unlock(&standin_mutex);
+
+    return SPI_SUCCESS;
+}
+
+/* Requests complete within rpi_spi_submit(): there is no bus to overlap with */
+int rpi_spi_submit(unsigned bus_number, rpi_spi_request_t *request)
+{
+    if (request == NULL)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    request->bus_number = bus_number;
+    request->result = rpi_spi_transfer_list(bus_number, request->device_number,
+                                            request->segments, request->segment_count);
+
+    if (request->callback != NULL)
+    {
+        request->callback(request, request->callback_arg);
+    }
+    request->busy = false;
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_wait(rpi_spi_request_t *request)
+{
+    if (request == NULL || request->bus_number >= STANDIN_MAX_BUSES)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    return request->result;
+}
+
+bool rpi_spi_is_complete(rpi_spi_request_t *request)
+{
+    return true;
+}
+
+int rpi_spi_set_priority(unsigned bus_number, unsigned device_number, rpi_spi_priority_t priority)
+{
+    return valid_device(bus_number, device_number) && priority < SPI_PRIORITY_COUNT ? SPI_SUCCESS : SPI_ERROR_BAD_ARGUMENT;
+}
+
+/* There is no bus to wait for: every latency is reported as zero, and the headless build does not print them */
+int rpi_spi_get_latency_stats(unsigned bus_number, rpi_spi_priority_t priority, rpi_spi_latency_stats_t *stats)
+{
+    if (bus_number >= STANDIN_MAX_BUSES || stats == NULL)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_cleanup_device(unsigned bus_number, unsigned device_number)
+{
+    return SPI_SUCCESS;
+}
+
+void standin_report(void)
+{
+    pthread_mutex_lock(&standin_mutex);
+
+    for (unsigned bus = 0; bus < STANDIN_MAX_BUSES; bus++)
+    {
+        for (unsigned device = 0; device < STANDIN_MAX_DEVICES; device++)
+        {
+            standin_device_t *dev = &standin_devices[bus][device];
+
+            if (dev->kind == STANDIN_MCP3008)
+            {
+                printf("spi%u/dev%u MCP3008: %llu exchanges, %llu bytes, %llu conversions\n", bus, device,
+                       (unsigned long long)dev->exchanges, (unsigned long long)dev->bytes,
+                       (unsigned long long)dev->conversions);
+            }
+            else if (dev->kind == STANDIN_MAX7219)
+            {
+                printf("spi%u/dev%u MAX7219 x%u: %llu flushes, %llu exchanges, %llu bytes, %llu row writes, "
+                       "%llu no-ops, %llu control writes\n", bus, device, dev->modules,
+                       (unsigned long long)dev->flushes, (unsigned long long)dev->exchanges,
+                       (unsigned long long)dev->bytes, (unsigned long long)dev->row_writes,
+                       (unsigned long long)dev->noops, (unsigned long long)dev->control_writes);
+            }
+        }
+    }
+
+    if (standin_capture != NULL)
+    {
+        fclose(standin_capture);
+        standin_capture = NULL;
+    }
+
+    pthread_mutex_unlock(&standin_mutex);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SPI_STANDIN_H
+#define SPI_STANDIN_H
+
+#include <stdbool.h>
+
+/* Return codes for client API */
+#define STANDIN_SUCCESS 0
+#define STANDIN_ERROR_BAD_ARGUMENT -1
+#define STANDIN_ERROR_FILE -2
+
+#define STANDIN_MAX_TRACE_POINTS 4096
+#define STANDIN_MAX_MODULES 8 // MAX7219s cascaded on one chip select
+
+/*
+ * In-process stand-ins for the devices of the headless build. The rpi_spi
+ * functions are implemented here: exchanges with the MCP3008 return the
+ * joystick position of a recorded trace, and exchanges with the MAX7219 are
+ * decoded into a framebuffer that can be captured to a file. Every exchange
+ * is counted.
+ *
+ * A trace is a text file with one "time_ms x y" line per change of position,
+ * x and y being raw 10-bit ADC readings (512 is the center); the position is
+ * held until the next line. Lines starting with # are comments.
+ */
+
+/**
+ * Load a joystick trace; time 0 of the trace is the moment it is loaded
+ *
+ * @param    path        trace file
+ *
+ * @returns  STANDIN_SUCCESS             on success,
+ *           STANDIN_ERROR_FILE          the file could not be read, is empty, or has
+ *                                       more than STANDIN_MAX_TRACE_POINTS lines
+ */
+int standin_load_trace(const char *path);
+
+/**
+ * Write a line with the time and the eight rows of the matrix every time a
+ * flush changes it; a row is written as the bytes of its modules, left to
+ * right, in hex
+ *
+ * @param    path        capture file, overwritten
+ *
+ * @returns  STANDIN_SUCCESS             on success,
+ *           STANDIN_ERROR_FILE          the file could not be created
+ */
+int standin_capture_open(const char *path);
+
+/**
+ * Emulate an MCP3008 on a bus and device, channel 0 giving the trace's x and
+ * channel 1 its y
+ *
+ * @param    bus         SPI bus number
+ * @param    device      SPI device number
+ *
+ * @returns  STANDIN_SUCCESS             on success,
+ *           STANDIN_ERROR_BAD_ARGUMENT  invalid bus or device
+ */
+int standin_attach_mcp3008(unsigned bus, unsigned device);
+
+/**
+ * Emulate a chain of MAX7219 matrix modules on a bus and device. Each command
+ * shifts through the chain as on the real devices, so a run of commands
+ * shorter or longer than the chain is decoded the way the hardware would.
+ *
+ * @param    bus         SPI bus number
+ * @param    device      SPI device number
+ * @param    modules     number of cascaded modules, 1 to STANDIN_MAX_MODULES
+ *
+ * @returns  STANDIN_SUCCESS             on success,
+ *           STANDIN_ERROR_BAD_ARGUMENT  invalid bus, device or module count
+ */
+int standin_attach_max7219(unsigned bus, unsigned device, unsigned modules);
+
+/**
+ * Check whether the replay has gone past the last point of the trace
+ *
+ * @returns  true once the trace is over (always true if none was loaded)
+ */
+bool standin_trace_finished(void);
+
+/**
+ * Print the SPI command counts of every emulated device and close the capture
+ */
+void standin_report(void);
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/neutrino.h>
+#include "game_timer.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int game_timer_start(game_timer_t *timer, uint64_t period_ns)
+{
+    if (timer == NULL || period_ns == 0)
+    {
+        return GAME_TIMER_ERROR_BAD_ARGUMENT;
+    }
+
+    memset(timer, 0, sizeof(*timer));
+    timer->period_ns = period_ns;
+
+    timer->chid = ChannelCreate(_NTO_CHF_PRIVATE);
+    if (timer->chid == -1)
+    {
+        perror("ChannelCreate");
+        return GAME_TIMER_ERROR_SETUP_FAILED;
+    }
+
+    timer->coid = ConnectAttach(ND_LOCAL_NODE, 0, timer->chid, _NTO_SIDE_CHANNEL, 0);
+    if (timer->coid == -1)
+    {
+        perror("ConnectAttach");
+        ChannelDestroy(timer->chid);
+        return GAME_TIMER_ERROR_SETUP_FAILED;
+    }
+
+    struct sigevent event;
+    SIGEV_PULSE_INIT(&event, timer->coid, SIGEV_PULSE_PRIO_INHERIT, GAME_TIMER_PULSE_CODE, 0);
+
+    if (timer_create(CLOCK_MONOTONIC, &event, &timer->timer) == -1)
+    {
+        perror("timer_create");
+        ConnectDetach(timer->coid);
+        ChannelDestroy(timer->chid);
+        return GAME_TIMER_ERROR_SETUP_FAILED;
+    }
+
+    struct itimerspec period = {
+        .it_value = {.tv_sec = period_ns / 1000000000ULL, .tv_nsec = period_ns % 1000000000ULL},
+        .it_interval = {.tv_sec = period_ns / 1000000000ULL, .tv_nsec = period_ns % 1000000000ULL}};
+
+    timer->start_ns = now_ns();
+    if (timer_settime(timer->timer, 0, &period, NULL) == -1)
+    {
+        perror("timer_settime");
+        game_timer_stop(timer);
+        return GAME_TIMER_ERROR_SETUP_FAILED;
+    }
+
+    return GAME_TIMER_SUCCESS;
+}
+
+int game_timer_wait(game_timer_t *timer)
+{
+    for (;;)
+    {
+        // Pulses that queued up while the caller was busy return at once and are absorbed here
+        uint64_t elapsed = (now_ns() - timer->start_ns) / timer->period_ns;
+        if (elapsed > timer->ticks)
+        {
+            int due = (int)(elapsed - timer->ticks);
+            timer->ticks = elapsed;
+            return due;
+        }
+
+        struct _pulse pulse;
+        if (MsgReceivePulse(timer->chid, &pulse, sizeof(pulse), NULL) == -1)
+        {
+            perror("MsgReceivePulse");
+            return GAME_TIMER_ERROR_RECEIVE;
+        }
+    }
+}
+
+void game_timer_stop(game_timer_t *timer)
+{
+    timer_delete(timer->timer);
+    ConnectDetach(timer->coid);
+    ChannelDestroy(timer->chid);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GAME_TIMER_H
+#define GAME_TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* Return codes for client API */
+#define GAME_TIMER_SUCCESS 0
+#define GAME_TIMER_ERROR_BAD_ARGUMENT -1
+#define GAME_TIMER_ERROR_SETUP_FAILED -2
+#define GAME_TIMER_ERROR_RECEIVE -3
+#define GAME_TIMER_STOPPED -4 // no more ticks (headless build: the replayed trace is over)
+
+#define GAME_TIMER_PULSE_CODE 1
+
+/*
+ * A periodic tick: a CLOCK_MONOTONIC timer delivering a pulse every period to
+ * a private channel. Ticks are counted from the start time rather than from
+ * the pulses, so a late wakeup reports every period that elapsed and the tick
+ * count never drifts.
+ */
+typedef struct
+{
+    int chid;
+    int coid;
+    timer_t timer;
+    uint64_t period_ns;
+    uint64_t start_ns;
+    uint64_t ticks;          // ticks reported so far
+} game_timer_t;
+
+/**
+ * Create the channel and the timer and start ticking
+ *
+ * @param    timer       timer state (output)
+ * @param    period_ns   tick period
+ *
+ * @returns  GAME_TIMER_SUCCESS             on success,
+ *           GAME_TIMER_ERROR_BAD_ARGUMENT  invalid pointer or zero period
+ *           GAME_TIMER_ERROR_SETUP_FAILED  the channel or the timer could not be created
+ */
+int game_timer_start(game_timer_t *timer, uint64_t period_ns);
+
+/**
+ * Wait for the next tick
+ *
+ * @param    timer       timer state
+ *
+ * @returns  the number of ticks elapsed since the previous call (1, or more if
+ *           the caller fell behind) on success,
+ *           GAME_TIMER_ERROR_RECEIVE       receiving the pulse failed
+ *           GAME_TIMER_STOPPED             no more ticks will come
+ */
+int game_timer_wait(game_timer_t *timer);
+
+/**
+ * Delete the timer and the channel
+ *
+ * @param    timer       timer state
+ */
+void game_timer_stop(game_timer_t *timer);
+
+#endif
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "joystick_input.h"
+
+#define CALIBRATION_TIME_US 200000        // stick at rest while the center is measured
+#define POLL_INTERVAL_NS    1000000ULL    // how often the scan ring is drained
+#define INITIAL_SPAN        60            // assumed travel, % of the distance from center to the rail
+#define DEADZONE_EXIT       80            // % of the deadzone at which the stick returns to center
+#define TAN_22_5            414           // tan(22.5 degrees) * 1000, edge of the diagonal sectors
+#define FILTER_FRAC_BITS    8
+#define SAMPLE_BATCH        64
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Scale a filtered reading to -JOYSTICK_FULL_SCALE..JOYSTICK_FULL_SCALE around the calibrated center */
+static int32_t normalize(int32_t value, int32_t center, int32_t min, int32_t max)
+{
+    int32_t span = value >= center ? max - center : center - min;
+    if (span <= 0)
+    {
+        return 0;
+    }
+
+    int32_t scaled = (value - center) * JOYSTICK_FULL_SCALE / span;
+    if (scaled > JOYSTICK_FULL_SCALE)
+    {
+        scaled = JOYSTICK_FULL_SCALE;
+    }
+    if (scaled < -JOYSTICK_FULL_SCALE)
+    {
+        scaled = -JOYSTICK_FULL_SCALE;
+    }
+    return scaled;
+}
+
+/* Map a normalized position onto eight 45 degree sectors, with a radial deadzone around the center */
+static joystick_direction_t classify(int32_t x, int32_t y, unsigned deadzone, joystick_direction_t previous)
+{
+    // Leaving the center needs the full deadzone, returning to it a little less, so the edge does not chatter
+    int64_t radius = previous == JOYSTICK_CENTER ? deadzone : deadzone * DEADZONE_EXIT / 100;
+    if ((int64_t)x * x + (int64_t)y * y < radius * radius)
+    {
+        return JOYSTICK_CENTER;
+    }
+
+    int32_t ax = x < 0 ? -x : x;
+    int32_t ay = y < 0 ? -y : y;
+
+    if (ay * 1000 < ax * TAN_22_5)
+    {
+        return x < 0 ? JOYSTICK_LEFT : JOYSTICK_RIGHT;
+    }
+    if (ax * 1000 < ay * TAN_22_5)
+    {
+        return y < 0 ? JOYSTICK_UP : JOYSTICK_DOWN;
+    }
+    if (y < 0)
+    {
+        return x < 0 ? JOYSTICK_UP_LEFT : JOYSTICK_UP_RIGHT;
+    }
+    return x < 0 ? JOYSTICK_DOWN_LEFT : JOYSTICK_DOWN_RIGHT;
+}
+
+/* Queue an event for the consumer, overwriting the oldest one if it is not keeping up; called with the mutex held */
+static void push_event(joystick_input_t *js, const joystick_event_t *event)
+{
+    if (js->event_count == JOYSTICK_EVENT_QUEUE)
+    {
+        js->event_head = (js->event_head + 1) % JOYSTICK_EVENT_QUEUE;
+        js->event_count--;
+        js->events_lost++;
+    }
+
+    js->events[(js->event_head + js->event_count) % JOYSTICK_EVENT_QUEUE] = *event;
+    js->event_count++;
+    pthread_cond_broadcast(&js->cond);
+}
+
+/* Run a sample through the filter and widen the calibrated range if the stick moved further than seen before */
+static void filter_sample(joystick_input_t *js, const mcp3008_sample_t *sample)
+{
+    int32_t raw_x = (int32_t)sample->value[js->channel_x] << FILTER_FRAC_BITS;
+    int32_t raw_y = (int32_t)sample->value[js->channel_y] << FILTER_FRAC_BITS;
+
+    js->filtered_x += (raw_x - js->filtered_x) >> js->filter_shift;
+    js->filtered_y += (raw_y - js->filtered_y) >> js->filter_shift;
+
+    int32_t x = js->filtered_x >> FILTER_FRAC_BITS;
+    int32_t y = js->filtered_y >> FILTER_FRAC_BITS;
+
+    if (x < js->min_x) js->min_x = x;
+    if (x > js->max_x) js->max_x = x;
+    if (y < js->min_y) js->min_y = y;
+    if (y > js->max_y) js->max_y = y;
+}
+
+static void *input_thread(void *arg)
+{
+    joystick_input_t *js = arg;
+    mcp3008_sample_t samples[SAMPLE_BATCH];
+    struct timespec interval = {.tv_sec = 0, .tv_nsec = POLL_INTERVAL_NS};
+
+    for (;;)
+    {
+        uint64_t timestamp_ns = 0;
+        unsigned count;
+
+        while ((count = mcp3008_scan_read(js->scan, samples, SAMPLE_BATCH)) > 0)
+        {
+            for (unsigned i = 0; i < count; i++)
+            {
+                filter_sample(js, &samples[i]);
+            }
+            timestamp_ns = samples[count - 1].timestamp_ns;
+        }
+
+        pthread_mutex_lock(&js->mutex);
+        if (!js->running)
+        {
+            pthread_mutex_unlock(&js->mutex);
+            break;
+        }
+
+        if (timestamp_ns != 0)
+        {
+            joystick_state_t state = {.timestamp_ns = timestamp_ns};
+            state.x = normalize(js->filtered_x >> FILTER_FRAC_BITS, js->center_x, js->min_x, js->max_x);
+            state.y = normalize(js->filtered_y >> FILTER_FRAC_BITS, js->center_y, js->min_y, js->max_y);
+            state.direction = classify(state.x, state.y, js->deadzone, js->state.direction);
+
+            if (state.direction != js->state.direction)
+            {
+                push_event(js, &state);
+            }
+            js->state = state;
+        }
+        pthread_mutex_unlock(&js->mutex);
+
+        nanosleep(&interval, NULL);
+    }
+
+    return NULL;
+}
+
+/* Measure the rest position, and assume a conservative travel until the stick has been moved */
+static int calibrate(joystick_input_t *js)
+{
+    mcp3008_sample_t samples[SAMPLE_BATCH];
+    uint64_t sum_x = 0;
+    uint64_t sum_y = 0;
+    unsigned total = 0;
+    unsigned count;
+
+    // Discard anything scanned before the stick was known to be at rest
+    while (mcp3008_scan_read(js->scan, samples, SAMPLE_BATCH) > 0)
+    {
+    }
+
+    usleep(CALIBRATION_TIME_US);
+
+    while ((count = mcp3008_scan_read(js->scan, samples, SAMPLE_BATCH)) > 0)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            sum_x += samples[i].value[js->channel_x];
+            sum_y += samples[i].value[js->channel_y];
+        }
+        total += count;
+    }
+
+    if (total == 0)
+    {
+        return JOYSTICK_INPUT_ERROR_CALIBRATION;
+    }
+
+    js->center_x = sum_x / total;
+    js->center_y = sum_y / total;
+
+    js->min_x = js->center_x - js->center_x * INITIAL_SPAN / 100;
+    js->max_x = js->center_x + (MCP3008_MAX_VALUE - js->center_x) * INITIAL_SPAN / 100;
+    js->min_y = js->center_y - js->center_y * INITIAL_SPAN / 100;
+    js->max_y = js->center_y + (MCP3008_MAX_VALUE - js->center_y) * INITIAL_SPAN / 100;
+
+    js->filtered_x = js->center_x << FILTER_FRAC_BITS;
+    js->filtered_y = js->center_y << FILTER_FRAC_BITS;
+
+    return JOYSTICK_INPUT_SUCCESS;
+}
+
+void joystick_input_init(joystick_input_t *js, mcp3008_scan_t *scan, uint8_t channel_x, uint8_t channel_y)
+{
+    memset(js, 0, sizeof(*js));
+    js->scan = scan;
+    js->channel_x = channel_x;
+    js->channel_y = channel_y;
+    js->filter_shift = JOYSTICK_DEFAULT_FILTER_SHIFT;
+    js->deadzone = JOYSTICK_DEFAULT_DEADZONE;
+
+    // Timed waits are measured against CLOCK_MONOTONIC, like the sample timestamps
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&js->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&js->mutex, NULL);
+}
+
+int joystick_input_start(joystick_input_t *js)
+{
+    if (js == NULL || js->scan == NULL ||
+        js->channel_x >= MCP3008_CHANNELS || js->channel_y >= MCP3008_CHANNELS ||
+        js->filter_shift > 15 || js->deadzone >= JOYSTICK_FULL_SCALE)
+    {
+        return JOYSTICK_INPUT_ERROR_BAD_ARGUMENT;
+    }
+
+    int status = calibrate(js);
+    if (status != JOYSTICK_INPUT_SUCCESS)
+    {
+        return status;
+    }
+
+    js->state = (joystick_state_t){.timestamp_ns = now_ns(), .direction = JOYSTICK_CENTER};
+    js->event_head = 0;
+    js->event_count = 0;
+    js->running = true;
+
+    if (pthread_create(&js->thread, NULL, input_thread, js) != EOK)
+    {
+        perror("pthread_create");
+        js->running = false;
+        return JOYSTICK_INPUT_ERROR_THREAD;
+    }
+
+    return JOYSTICK_INPUT_SUCCESS;
+}
+
+int joystick_input_wait(joystick_input_t *js, joystick_event_t *event, uint64_t timeout_ns)
+{
+    uint64_t deadline_ns = now_ns() + timeout_ns;
+    struct timespec deadline = {
+        .tv_sec = deadline_ns / 1000000000ULL,
+        .tv_nsec = deadline_ns % 1000000000ULL};
+    int status = JOYSTICK_INPUT_SUCCESS;
+
+    pthread_mutex_lock(&js->mutex);
+    while (js->running && js->event_count == 0)
+    {
+        if (pthread_cond_timedwait(&js->cond, &js->mutex, &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+
+    if (js->event_count > 0)
+    {
+        *event = js->events[js->event_head];
+        js->event_head = (js->event_head + 1) % JOYSTICK_EVENT_QUEUE;
+        js->event_count--;
+    }
+    else
+    {
+        status = js->running ? JOYSTICK_INPUT_TIMEOUT : JOYSTICK_INPUT_STOPPED;
+    }
+    pthread_mutex_unlock(&js->mutex);
+
+    return status;
+}
+
+void joystick_input_get_state(joystick_input_t *js, joystick_state_t *state)
+{
+    pthread_mutex_lock(&js->mutex);
+    *state = js->state;
+    pthread_mutex_unlock(&js->mutex);
+}
+
+void joystick_input_stop(joystick_input_t *js)
+{
+    pthread_mutex_lock(&js->mutex);
+    bool was_running = js->running;
+    js->running = false;
+    pthread_cond_broadcast(&js->cond);
+    pthread_mutex_unlock(&js->mutex);
+
+    if (was_running)
+    {
+        pthread_join(js->thread, NULL);
+    }
+}
+
+const char *joystick_direction_to_string(joystick_direction_t direction)
+{
+    switch (direction)
+    {
+    case JOYSTICK_CENTER:     return "CENTER";
+    case JOYSTICK_UP:         return "UP";
+    case JOYSTICK_DOWN:       return "DOWN";
+    case JOYSTICK_LEFT:       return "LEFT";
+    case JOYSTICK_RIGHT:      return "RIGHT";
+    case JOYSTICK_UP_LEFT:    return "UP_LEFT";
+    case JOYSTICK_UP_RIGHT:   return "UP_RIGHT";
+    case JOYSTICK_DOWN_LEFT:  return "DOWN_LEFT";
+    case JOYSTICK_DOWN_RIGHT: return "DOWN_RIGHT";
+    default:                  return "UNKNOWN";
+    }
+}
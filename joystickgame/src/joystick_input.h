@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JOYSTICK_INPUT_H
+#define JOYSTICK_INPUT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "mcp3008.h"
+
+/* Return codes for client API */
+#define JOYSTICK_INPUT_SUCCESS 0
+#define JOYSTICK_INPUT_ERROR_BAD_ARGUMENT -1
+#define JOYSTICK_INPUT_ERROR_CALIBRATION -2
+#define JOYSTICK_INPUT_ERROR_THREAD -3
+#define JOYSTICK_INPUT_TIMEOUT -4
+#define JOYSTICK_INPUT_STOPPED -5
+
+#define JOYSTICK_FULL_SCALE 1000         // normalized deflection at the end of travel
+#define JOYSTICK_DEFAULT_FILTER_SHIFT 3  // IIR time constant of 8 samples
+#define JOYSTICK_DEFAULT_DEADZONE 200    // 20% of full deflection
+#define JOYSTICK_EVENT_QUEUE 16
+
+/* Joystick directions, up is towards lower Y readings */
+typedef enum
+{
+    JOYSTICK_CENTER,
+    JOYSTICK_UP,
+    JOYSTICK_DOWN,
+    JOYSTICK_LEFT,
+    JOYSTICK_RIGHT,
+    JOYSTICK_UP_LEFT,
+    JOYSTICK_UP_RIGHT,
+    JOYSTICK_DOWN_LEFT,
+    JOYSTICK_DOWN_RIGHT
+} joystick_direction_t;
+
+/* Filtered joystick position */
+typedef struct
+{
+    uint64_t timestamp_ns;           // time of the newest ADC sample included
+    int32_t x;                       // -JOYSTICK_FULL_SCALE (left) .. JOYSTICK_FULL_SCALE (right)
+    int32_t y;                       // -JOYSTICK_FULL_SCALE (up) .. JOYSTICK_FULL_SCALE (down)
+    joystick_direction_t direction;
+} joystick_state_t;
+
+/* Emitted when the direction changes */
+typedef joystick_state_t joystick_event_t;
+
+/*
+ * Joystick input: consumes the samples of an MCP3008 scan, filters them and
+ * turns them into direction-change events. Every sample of the scan goes
+ * through the filter, so a scan rate above the update rate oversamples.
+ */
+typedef struct
+{
+    // Configuration, may be changed between joystick_input_init() and joystick_input_start()
+    mcp3008_scan_t *scan;            // running scan including both axes; its only consumer
+    uint8_t channel_x;
+    uint8_t channel_y;
+    unsigned filter_shift;           // IIR filter: y += (x - y) / 2^filter_shift
+    unsigned deadzone;               // radial deadzone, in JOYSTICK_FULL_SCALE units
+
+    // Calibration, center measured on start and range widened as the stick is moved
+    int32_t center_x;
+    int32_t center_y;
+    int32_t min_x;
+    int32_t max_x;
+    int32_t min_y;
+    int32_t max_y;
+
+    // Filter state, 8 fractional bits
+    int32_t filtered_x;
+    int32_t filtered_y;
+
+    // Shared with consumers, protected by mutex
+    joystick_state_t state;
+    joystick_event_t events[JOYSTICK_EVENT_QUEUE];
+    unsigned event_head;
+    unsigned event_count;
+    uint64_t events_lost;            // events overwritten before they were read
+    bool running;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+} joystick_input_t;
+
+/**
+ * Set the default configuration
+ *
+ * @param    js          joystick state (output)
+ * @param    scan        running MCP3008 scan including both channels
+ * @param    channel_x   ADC channel of the X axis
+ * @param    channel_y   ADC channel of the Y axis
+ */
+void joystick_input_init(joystick_input_t *js, mcp3008_scan_t *scan, uint8_t channel_x, uint8_t channel_y);
+
+/**
+ * Calibrate the center position (the stick must be at rest) and start the
+ * input thread
+ *
+ * @param    js          joystick state
+ *
+ * @returns  JOYSTICK_INPUT_SUCCESS             on success,
+ *           JOYSTICK_INPUT_ERROR_BAD_ARGUMENT  invalid configuration
+ *           JOYSTICK_INPUT_ERROR_CALIBRATION   no samples received from the scan
+ *           JOYSTICK_INPUT_ERROR_THREAD        the input thread could not be created
+ */
+int joystick_input_start(joystick_input_t *js);
+
+/**
+ * Wait for the next direction change
+ *
+ * @param    js          joystick state
+ * @param    event       the event (output)
+ * @param    timeout_ns  maximum time to wait
+ *
+ * @returns  JOYSTICK_INPUT_SUCCESS    an event was returned,
+ *           JOYSTICK_INPUT_TIMEOUT    no direction change within the timeout
+ *           JOYSTICK_INPUT_STOPPED    the input thread is not running
+ */
+int joystick_input_wait(joystick_input_t *js, joystick_event_t *event, uint64_t timeout_ns);
+
+/**
+ * Read the current filtered position without waiting
+ *
+ * @param    js          joystick state
+ * @param    state       current position and direction (output)
+ */
+void joystick_input_get_state(joystick_input_t *js, joystick_state_t *state);
+
+/**
+ * Stop the input thread and wake any waiting consumer
+ *
+ * @param    js          joystick state
+ */
+void joystick_input_stop(joystick_input_t *js);
+
+/**
+ * Name of a direction
+ *
+ * @param    direction   joystick direction
+ *
+ * @returns  a human-readable string
+ */
+const char *joystick_direction_to_string(joystick_direction_t direction);
+
+#endif
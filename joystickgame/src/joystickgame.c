@@ -18,7 +18,16 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include "rpi_spi.h"
+#include "mcp3008.h"
+#include "joystick_input.h"
+#include "max7219.h"
+#include "game_timer.h"
+#ifdef JOYSTICKGAME_HEADLESS
+#include "spi_standin.h" // In-process MCP3008 and MAX7219 of the headless build
+#endif
 
 // ********************************************************************************************
 // Joystick related functions
@@ -29,94 +38,19 @@
 #define JOYSTICK_DEVICE 0 // Joystick is device 0, matrix is device 1
 #define JOYSTICK_SPI_SPEED 1000000 // 1 MHz
 
-// MCP3008 SPI command bits
-#define MCP3008_START_BIT      0x01
-#define MCP3008_SGL_DIFF       0x08  // Single-ended mode
-#define MCP3008_DONT_CARE      0x00
-
-// Joystick calibration
-#define JOY_CENTER 512
-#define DEADZONE   100
-
-// MCP3008 has 8 input channels
-#define MCP3008_MAX_CHANNEL 7
-
-// Enumeration of possible joystick directions
-typedef enum {
-    DIR_CENTER,
-    DIR_UP,
-    DIR_DOWN,
-    DIR_LEFT,
-    DIR_RIGHT,
-    DIR_UP_LEFT,
-    DIR_UP_RIGHT,
-    DIR_DOWN_LEFT,
-    DIR_DOWN_RIGHT
-} JoystickDirection;
+// Joystick axes on the MCP3008 and how often they are scanned
+#define JOYSTICK_CHANNEL_X 0
+#define JOYSTICK_CHANNEL_Y 1
+#define JOYSTICK_SCAN_RATE_HZ 4000 // 4 samples per 1ms input update
+
+// The ADC, its scan thread, and the filtered direction events built on top of it
+static mcp3008_t joystickAdc;
+static mcp3008_scan_t joystickScan;
+static joystick_input_t joystick;
 
 // Control flag for main loop
 bool running = true;
 
-// Reads a 10-bit analog value from the MCP3008 on the specified channel
-int mcp3008_read_channel(uint8_t channel, uint16_t *result) {
-    if (channel > MCP3008_MAX_CHANNEL || result == NULL) {
-        return 0;
-    }
-
-    uint8_t write_buffer[3];
-    write_buffer[0] = MCP3008_START_BIT;
-    write_buffer[1] = (MCP3008_SGL_DIFF | channel) << 4;
-    write_buffer[2] = MCP3008_DONT_CARE;
-
-    uint8_t read_buffer[3] = {0};
-
-    if (rpi_spi_write_read_data(JOYSTICK_BUS, JOYSTICK_DEVICE, write_buffer, read_buffer, 3) != SPI_SUCCESS) {
-        fprintf(stderr, "SPI read failed\n");
-        return 0;
-    }
-
-    *result = ((read_buffer[1] & 0x03) << 8) | read_buffer[2];  // Combine 10-bit result
-    return 1;
-}
-
-// Converts raw x and y analog values to a joystick direction
-JoystickDirection get_joystick_direction(int x, int y) {
-    int dx = x - JOY_CENTER;
-    int dy = y - JOY_CENTER;
-
-    int is_left   = dx < -DEADZONE;
-    int is_right  = dx >  DEADZONE;
-    int is_up     = dy < -DEADZONE;
-    int is_down   = dy >  DEADZONE;
-
-    if (is_up && is_left) return DIR_UP_LEFT;
-    if (is_up && is_right) return DIR_UP_RIGHT;
-    if (is_down && is_left) return DIR_DOWN_LEFT;
-    if (is_down && is_right) return DIR_DOWN_RIGHT;
-    if (is_up) return DIR_UP;
-    if (is_down) return DIR_DOWN;
-    if (is_left) return DIR_LEFT;
-    if (is_right) return DIR_RIGHT;
-
-    return DIR_CENTER;
-}
-
-// Converts joystick direction enum to a human-readable string
-const char* joystick_direction_to_string(JoystickDirection dir) {
-    switch (dir) {
-        case DIR_CENTER:     return "CENTER";
-        case DIR_UP:         return "UP";
-        case DIR_DOWN:       return "DOWN";
-        case DIR_LEFT:       return "LEFT";
-        case DIR_RIGHT:      return "RIGHT";
-        case DIR_UP_LEFT:    return "UP_LEFT";
-        case DIR_UP_RIGHT:   return "UP_RIGHT";
-        case DIR_DOWN_LEFT:  return "DOWN_LEFT";
-        case DIR_DOWN_RIGHT: return "DOWN_RIGHT";
-        default:             return "UNKNOWN";
-    }
-}
-
 // ********************************************************************************************
 // Matrix related functions
 // ********************************************************************************************
@@ -125,91 +59,38 @@ const char* joystick_direction_to_string(JoystickDirection dir) {
 #define MATRIX_BUS 0 // Joystick is also on BUS 0
 #define MATRIX_DEVICE 1 // Joystick is device 0, matrix is device 1
 #define MATRIX_SPI_SPEED 1000000 // 1 MHz
+#ifndef MATRIX_MODULES
+#define MATRIX_MODULES 1 // Cascaded 8x8 modules, set by the Makefile (make MATRIX_MODULES=4)
+#endif
 
-// MAX7219 command registers
-#define CMD_DIGIT0     0x01
-#define CMD_DECODEMODE 0x09
-#define CMD_BRIGHTNESS 0x0A
-#define CMD_SCANLIMIT  0x0B
-#define CMD_SHUTDOWN   0x0C
-#define CMD_DISPLAYTEST 0x0F
-
-// Current state of each row on the LED matrix
-uint8_t matrixState[8] = {0};
-
-// The players position in the matrix
-int matrixX = 0;
-int matrixY = 0;
-
-// Sends a register/value command to the MAX7219
-int max7219_send(uint8_t reg, uint8_t val) {
-    uint8_t buffer[2] = {reg, val};
-    if (rpi_spi_write_read_data(MATRIX_BUS, MATRIX_DEVICE, buffer, NULL, 2) != SPI_SUCCESS) {
-        fprintf(stderr, "Failed to send SPI data\n");
-        return 0;
-    }
-    return 1;
-}
-
-// Clears all LEDs on the matrix
-int max7219_clear() {
-    for (uint8_t i = 0; i < 8; i++) {
-        if (!max7219_send(CMD_DIGIT0 + i, 0x00)) {
-            fprintf(stderr, "Failed to clear display\n");
-            return 0;
-        }
-    }
-    return 1;
-}
-
-// Initializes the MAX7219 for use with an 8x8 LED matrix
-int max7219_init(uint8_t intensity) {
-    if (rpi_spi_configure_device(MATRIX_BUS, MATRIX_DEVICE,
-        SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0,
-        MATRIX_SPI_SPEED) != SPI_SUCCESS) {
-        fprintf(stderr, "Failed to configure SPI device\n");
-        return 0;
-    }
-
-    // Initialization sequence
-    if (!max7219_send(CMD_SHUTDOWN, 0) ||            // Enter shutdown
-        !max7219_send(CMD_DISPLAYTEST, 0) ||         // Disable test mode
-        !max7219_send(CMD_SCANLIMIT, 7) ||           // Enable all rows
-        !max7219_send(CMD_DECODEMODE, 0) ||          // Use raw LED values
-        !max7219_send(CMD_BRIGHTNESS, intensity) ||  // Set brightness
-        !max7219_send(CMD_SHUTDOWN, 1)) {            // Turn on display
-
-        fprintf(stderr, "Failed to send init command to MAX7219\n");
-        return 0;
-    }
-
-    return max7219_clear(); // Clear the screen on startup
-}
+// The LED matrix framebuffer: drawing only changes memory, each frame ends with one flush
+static max7219_t matrix;
 
 // Lights up an individual pixel at (x, y)
 void lightPixel(uint8_t x, uint8_t y) {
-    if (x > 7 || y > 7) return;
-    matrixState[y] |= (1 << (7 - x));
-    max7219_send(CMD_DIGIT0 + y, matrixState[y]);
+    max7219_fb_set_pixel(&matrix, x, y, true);
 }
 
 // Turns off an individual pixel at (x, y)
 void clearPixel(uint8_t x, uint8_t y) {
-    if (x > 7 || y > 7) return;
-    matrixState[y] &= ~(1 << (7 - x));
-    max7219_send(CMD_DIGIT0 + y, matrixState[y]);
+    max7219_fb_set_pixel(&matrix, x, y, false);
 }
 
-// Shows a flashing "win" animation (X across the matrix)
+// Shows a flashing "win" animation (X across every module of the matrix)
 void showWinMatrix() {
-    max7219_clear();
+    max7219_fb_clear(&matrix);
+    max7219_flush(&matrix);
     for (int j = 0; j < 3; j++) {
-        for (int i = 0; i < 8; i++) {
-            lightPixel(i, i);        // Diagonal from top-left to bottom-right
-            lightPixel(7 - i, i);    // Diagonal from top-right to bottom-left
+        for (int m = 0; m < MATRIX_MODULES; m++) {
+            for (int i = 0; i < 8; i++) {
+                lightPixel(8 * m + i, i);        // Diagonal from top-left to bottom-right
+                lightPixel(8 * m + 7 - i, i);    // Diagonal from top-right to bottom-left
+            }
         }
+        max7219_flush(&matrix);
         usleep(100000);  // Pause
-        max7219_clear(); // Flash effect
+        max7219_fb_clear(&matrix); // Flash effect
+        max7219_flush(&matrix);
         usleep(50000);
     }
 }
@@ -218,144 +99,432 @@ void showWinMatrix() {
 // Game related functions
 // ********************************************************************************************
 
-// Food-related game mechanics
-#define FOOD_SPAWN_INTERVAL_NS 1000000000L // 1 second
-
-// Food grid and tracking
-static int foodMatrix[8][8] = {{0}};
-static int foodRemaining = 0;
-static struct timespec lastFoodSpawn = {0};
+// The game advances in fixed steps of SIM_TICK_NS, driven by a periodic timer; durations are in steps
+#define SIM_TICK_NS 10000000ULL // 100 steps per second
+#define MOVE_REPEAT_TICKS 10 // While the joystick is held in one direction, the player moves every 100ms
+#define FOOD_SPAWN_TICKS 100 // A new food item every second
+#define RENDER_TICKS 2 // Frames are sent at most every 20ms (50 fps)
+#define MAX_CATCHUP_TICKS 5 // Steps run at once after a late wakeup; older ones are dropped
+
+// Time spent in each loop iteration (input, steps and render), kept for the percentiles printed at exit
+#define MAX_LOOP_SAMPLES 65536
+static uint32_t loopTimes[MAX_LOOP_SAMPLES];
+static unsigned loopTimeCount = 0;
+
+// The world is larger than the matrix, which shows a viewport onto it that follows the player
+#define WORLD_WIDTH 32 // Up to 64 columns
+#define WORLD_HEIGHT 16
+#define VIEW_WIDTH (MAX7219_COLS * MATRIX_MODULES)
+#define VIEW_HEIGHT MAX7219_ROWS
+#define SCROLL_MARGIN 2 // The viewport scrolls when the player gets closer than this to its edge
+
+#if VIEW_WIDTH > WORLD_WIDTH || WORLD_WIDTH > 64 || VIEW_HEIGHT > WORLD_HEIGHT
+#error "The world must be at least as large as the matrix, and at most 64 columns wide"
+#endif
+
+// Rows of cells as 64-bit masks with column x in bit 63 - x, so the top byte of a viewport row is the row of the
+// leftmost module, the next byte the row of the next module, and so on, each with its leftmost column in bit 7
+#define COLUMN_BIT(x) (1ULL << (63 - (x)))
+#define WORLD_ROW_MASK (~0ULL << (64 - WORLD_WIDTH))
+#define VIEW_ROW_MASK (~0ULL << (64 - VIEW_WIDTH))
+
+static uint64_t worldFood[WORLD_HEIGHT];
+static unsigned foodCount = 0;
+static int playerX = 0;
+static int playerY = 0;
+static bool gameWon = false;
+
+// The food inside the viewport, row 0 being world row viewY and bit 63 column viewX. It is kept up to date as the
+// viewport scrolls, recomputing only the rows and columns that scroll in; rows that changed since the last frame
+// are marked in dirtyRows, and only those are redrawn
+static int viewX = 0;
+static int viewY = 0;
+static uint64_t viewFood[VIEW_HEIGHT];
+static uint8_t dirtyRows = 0xFF;
+
+// Input as seen by the simulation: the direction held, and a new direction not yet acted on
+static joystick_direction_t heldDirection = JOYSTICK_CENTER;
+static joystick_direction_t pendingDirection = JOYSTICK_CENTER;
+static int moveCountdown = 0;
+static uint64_t stepCount = 0;
 
 // Updates player position based on direction input
-void updatePosition(int *x, int *y, JoystickDirection dir) {
+void updatePosition(int *x, int *y, joystick_direction_t dir) {
     switch (dir) {
-        case DIR_UP:         (*y)--; break;
-        case DIR_DOWN:       (*y)++; break;
-        case DIR_LEFT:       (*x)--; break;
-        case DIR_RIGHT:      (*x)++; break;
-        case DIR_UP_LEFT:    (*x)--; (*y)--; break;
-        case DIR_UP_RIGHT:   (*x)++; (*y)--; break;
-        case DIR_DOWN_LEFT:  (*x)--; (*y)++; break;
-        case DIR_DOWN_RIGHT: (*x)++; (*y)++; break;
+        case JOYSTICK_UP:  (*y)--; break;
+        case JOYSTICK_DOWN:  (*y)++; break;
+        case JOYSTICK_LEFT:  (*x)--; break;
+        case JOYSTICK_RIGHT:  (*x)++; break;
+        case JOYSTICK_UP_LEFT:  (*x)--; (*y)--; break;
+        case JOYSTICK_UP_RIGHT:  (*x)++; (*y)--; break;
+        case JOYSTICK_DOWN_LEFT:  (*x)--; (*y)++; break;
+        case JOYSTICK_DOWN_RIGHT: (*x)++; (*y)++; break;
         default: break;
     }
 
-    // Clamp to 0–7 bounds
+    // Clamp to the world bounds
     if (*x < 0) *x = 0;
-    if (*x > 7) *x = 7;
+    if (*x > WORLD_WIDTH - 1) *x = WORLD_WIDTH - 1;
     if (*y < 0) *y = 0;
-    if (*y > 7) *y = 7;
+    if (*y > WORLD_HEIGHT - 1) *y = WORLD_HEIGHT - 1;
 }
 
-// Draw the food as pixels on the matrix
-void drawFood() {
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (matrixState[j] & (1 << (7 - i))) {
-                continue; // Skip if player is occupying this pixel
-            }
+// Columns x to x + count - 1 of a world row, moved to the top bits (column x in bit 63)
+uint64_t worldColumns(int y, int x, int count) {
+    uint64_t mask = count >= 64 ? ~0ULL : ~(~0ULL >> count);
+    return (worldFood[y] << x) & mask;
+}
 
-            if (foodMatrix[j][i]) {
-                lightPixel(i, j);
+// Marks the viewport row showing world row y for redrawing, if it is visible
+void markRowDirty(int y) {
+    if (y >= viewY && y < viewY + VIEW_HEIGHT) {
+        dirtyRows |= 1u << (y - viewY);
+    }
+}
+
+// Sets or clears a food cell in the world and, if it is visible, in the viewport
+void setFood(int x, int y, bool on) {
+    if (on) {
+        worldFood[y] |= COLUMN_BIT(x);
+    } else {
+        worldFood[y] &= ~COLUMN_BIT(x);
+    }
+
+    if (x >= viewX && x < viewX + VIEW_WIDTH && y >= viewY && y < viewY + VIEW_HEIGHT) {
+        if (on) {
+            viewFood[y - viewY] |= COLUMN_BIT(x - viewX);
+        } else {
+            viewFood[y - viewY] &= ~COLUMN_BIT(x - viewX);
+        }
+        dirtyRows |= 1u << (y - viewY);
+    }
+}
+
+// Moves the viewport to (newX, newY). The rows that stay visible are moved and shifted sideways; only the rows
+// and columns that scroll in are read from the world
+void scrollView(int newX, int newY) {
+    int dx = newX - viewX;
+    int dy = newY - viewY;
+    if (dx == 0 && dy == 0) {
+        return;
+    }
+
+    if (abs(dx) >= VIEW_WIDTH || abs(dy) >= VIEW_HEIGHT) {
+        // Nothing stays visible
+        for (int row = 0; row < VIEW_HEIGHT; row++) {
+            viewFood[row] = worldColumns(newY + row, newX, VIEW_WIDTH);
+        }
+    } else {
+        if (dy > 0) {
+            memmove(viewFood, viewFood + dy, (VIEW_HEIGHT - dy) * sizeof(viewFood[0]));
+        } else if (dy < 0) {
+            memmove(viewFood - dy, viewFood, (VIEW_HEIGHT + dy) * sizeof(viewFood[0]));
+        }
+
+        for (int row = 0; row < VIEW_HEIGHT; row++) {
+            int y = newY + row;
+            if ((dy > 0 && row >= VIEW_HEIGHT - dy) || (dy < 0 && row < -dy)) {
+                viewFood[row] = worldColumns(y, newX, VIEW_WIDTH); // Scrolled in
+            } else if (dx > 0) {
+                viewFood[row] = (viewFood[row] << dx) | (worldColumns(y, newX + VIEW_WIDTH - dx, dx) >> (VIEW_WIDTH - dx));
+            } else if (dx < 0) {
+                viewFood[row] = ((viewFood[row] >> -dx) & VIEW_ROW_MASK) | worldColumns(y, newX, -dx);
             }
         }
     }
+
+    viewX = newX;
+    viewY = newY;
+    dirtyRows = 0xFF;
+}
+
+// Where the viewport should start along one axis to keep the player SCROLL_MARGIN cells inside it
+int followPlayer(int view, int player, int viewSize, int worldSize) {
+    if (player < view + SCROLL_MARGIN) {
+        view = player - SCROLL_MARGIN;
+    } else if (player > view + viewSize - 1 - SCROLL_MARGIN) {
+        view = player - viewSize + 1 + SCROLL_MARGIN;
+    }
+
+    if (view < 0) view = 0;
+    if (view > worldSize - viewSize) view = worldSize - viewSize;
+    return view;
 }
 
-// Spawns a new food item at a random empty location
-void spawnFood() {
-    int x, y;
-    do {
-        x = rand() % 8;
-        y = rand() % 8;
-    } while (foodMatrix[y][x] || (matrixX == x && matrixY == y));
-
-    foodMatrix[y][x] = 1;
-    foodRemaining++;
+// Index of the n-th (from 0) set bit of a board, found by halving: six popcounts whatever the board holds
+int nthSetBit(uint64_t bits, unsigned n) {
+    int index = 0;
+    for (int width = 32; width > 0; width /= 2) {
+        uint64_t low = bits & ((1ULL << width) - 1);
+        unsigned count = __builtin_popcountll(low);
+        if (n >= count) {
+            n -= count;
+            bits >>= width;
+            index += width;
+        } else {
+            bits = low;
+        }
+    }
+    return index;
 }
 
-// Checks if enough time has passed to spawn new food, and if so spawns a single food
-void maybeSpawnFood() {
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
+// Free cells of a world row
+uint64_t freeCells(int y) {
+    uint64_t cells = ~worldFood[y] & WORLD_ROW_MASK;
+    if (y == playerY) {
+        cells &= ~COLUMN_BIT(playerX);
+    }
+    return cells;
+}
 
-    long elapsed_ns = (now.tv_sec - lastFoodSpawn.tv_sec) * 1000000000L + (now.tv_nsec - lastFoodSpawn.tv_nsec);
+// Spawns a new food item on a random free cell of the world, picked directly among the free cells
+void spawnFood() {
+    int count = 0;
+    for (int y = 0; y < WORLD_HEIGHT; y++) {
+        count += __builtin_popcountll(freeCells(y));
+    }
+    if (count == 0) {
+        return; // World full
+    }
 
-    if (elapsed_ns >= FOOD_SPAWN_INTERVAL_NS) {
-        spawnFood();
-        lastFoodSpawn = now;
+    int n = rand() % count;
+    for (int y = 0; y < WORLD_HEIGHT; y++) {
+        uint64_t cells = freeCells(y);
+        int rowCount = __builtin_popcountll(cells);
+        if (n < rowCount) {
+            setFood(63 - nthSetBit(cells, n), y, true);
+            foodCount++;
+            return;
+        }
+        n -= rowCount;
     }
 }
 
 // Checks if the player has moved onto a food item
 void checkFoodCollision() {
-    if (foodMatrix[matrixY][matrixX]) {
-        foodMatrix[matrixY][matrixX] = 0;
-        foodRemaining--;
+    if (worldFood[playerY] & COLUMN_BIT(playerX)) {
+        setFood(playerX, playerY, false);
+        foodCount--;
     }
 }
 
+// Takes the direction changes reported since the last step; a new direction moves the player on the next step,
+// even if the stick went back to the center in between
+void readInput() {
+    joystick_event_t event;
+    int status;
+    while ((status = joystick_input_wait(&joystick, &event, 0)) == JOYSTICK_INPUT_SUCCESS) {
+        heldDirection = event.direction;
+        if (event.direction != JOYSTICK_CENTER) {
+            pendingDirection = event.direction;
+        }
+    }
+
+    if (status == JOYSTICK_INPUT_STOPPED) {
+        fprintf(stderr, "Failed to read joystick\n");
+        running = false;
+    }
+}
+
+// Advances the game by one fixed step
+void simulateStep() {
+    joystick_direction_t move = JOYSTICK_CENTER;
+
+    if (pendingDirection != JOYSTICK_CENTER) {
+        move = pendingDirection;
+        pendingDirection = JOYSTICK_CENTER;
+    } else if (heldDirection != JOYSTICK_CENTER && --moveCountdown <= 0) {
+        move = heldDirection;
+    }
+
+    if (move != JOYSTICK_CENTER) {
+        markRowDirty(playerY);
+        updatePosition(&playerX, &playerY, move);
+        scrollView(followPlayer(viewX, playerX, VIEW_WIDTH, WORLD_WIDTH),
+                   followPlayer(viewY, playerY, VIEW_HEIGHT, WORLD_HEIGHT));
+        markRowDirty(playerY);
+        moveCountdown = MOVE_REPEAT_TICKS;
+        checkFoodCollision();
+    }
+
+    if (stepCount % FOOD_SPAWN_TICKS == 0) {
+        spawnFood();
+    }
+    stepCount++;
+
+    // Win condition: all food collected
+    if (foodCount == 0) {
+        gameWon = true;
+        running = false;
+    }
+}
+
+// Redraws the viewport rows that changed and starts sending them; the next steps run while they go out
+void renderFrame() {
+    for (int row = 0; row < VIEW_HEIGHT; row++) {
+        if (!(dirtyRows & (1u << row))) {
+            continue;
+        }
+
+        uint64_t lit = viewFood[row];
+        if (viewY + row == playerY) {
+            lit |= COLUMN_BIT(playerX - viewX);
+        }
+        for (unsigned module = 0; module < MATRIX_MODULES; module++) {
+            max7219_fb_set_row(&matrix, module, row, (uint8_t)(lit >> (56 - 8 * module)));
+        }
+    }
+    dirtyRows = 0;
+
+    if (max7219_flush_async(&matrix) < 0) {
+        fprintf(stderr, "Failed to update LED matrix\n");
+    }
+}
+
+// Current CLOCK_MONOTONIC time in nanoseconds
+uint64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int compareTimes(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Prints the median, 90th and 99th percentile and worst loop time
+void printLoopTimes() {
+    if (loopTimeCount == 0) {
+        return;
+    }
+
+    qsort(loopTimes, loopTimeCount, sizeof(loopTimes[0]), compareTimes);
+    printf("Loop time: p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us (%u loops)\n",
+           loopTimes[loopTimeCount * 50 / 100] / 1e3, loopTimes[loopTimeCount * 90 / 100] / 1e3,
+           loopTimes[loopTimeCount * 99 / 100] / 1e3, loopTimes[loopTimeCount - 1] / 1e3, loopTimeCount);
+}
+
 // ********************************************************************************************
 // Main program loop
 // ********************************************************************************************
 
-int main() {
+int main(int argc, char *argv[]) {
     srand(time(NULL)); // Seed RNG
 
+#ifdef JOYSTICKGAME_HEADLESS
+    // Headless build: replay a recorded joystick trace against in-process stand-ins of the devices
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s trace [capture]\n", argv[0]);
+        return 1;
+    }
+    srand(1); // The same food positions on every run
+    standin_attach_mcp3008(JOYSTICK_BUS, JOYSTICK_DEVICE);
+    standin_attach_max7219(MATRIX_BUS, MATRIX_DEVICE, MATRIX_MODULES);
+    if (standin_load_trace(argv[1]) != STANDIN_SUCCESS ||
+        (argc == 3 && standin_capture_open(argv[2]) != STANDIN_SUCCESS)) {
+        fprintf(stderr, "Failed to set up the replay\n");
+        return 1;
+    }
+#endif
+
     // Init SPI joystick
-    if (rpi_spi_configure_device(JOYSTICK_BUS, JOYSTICK_DEVICE,
-        SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0,
-        JOYSTICK_SPI_SPEED) != SPI_SUCCESS) {
+    if (mcp3008_init(&joystickAdc, JOYSTICK_BUS, JOYSTICK_DEVICE, JOYSTICK_SPI_SPEED) != MCP3008_SUCCESS) {
         fprintf(stderr, "Failed to configure joystick SPI\n");
         return 1;
     }
 
     // Init LED matrix
-    if (!max7219_init(0x08)) {
+    if (max7219_init(&matrix, MATRIX_BUS, MATRIX_DEVICE, MATRIX_MODULES, MATRIX_SPI_SPEED, 0x08) != MAX7219_SUCCESS) {
         fprintf(stderr, "Failed to initialize LED matrix\n");
         return 1;
     }
 
-    // Game loop
-    while (running) {
-        uint16_t xVal, yVal;
+    // Both devices share the bus: joystick samples go ahead of queued matrix rows
+    rpi_spi_set_priority(JOYSTICK_BUS, JOYSTICK_DEVICE, SPI_PRIORITY_REALTIME);
+    rpi_spi_set_priority(MATRIX_BUS, MATRIX_DEVICE, SPI_PRIORITY_BULK);
 
-        // Read joystick position
-        if (!mcp3008_read_channel(0, &xVal) || !mcp3008_read_channel(1, &yVal)) {
-            fprintf(stderr, "Failed to read joystick\n");
-            break;
-        }
-
-        JoystickDirection dir = get_joystick_direction(xVal, yVal);
-
-        // Clear player pixel from old position
-        clearPixel(matrixX, matrixY);
+    // Stream the joystick position and calibrate its center; the stick must be at rest
+    if (mcp3008_scan_start(&joystickScan, &joystickAdc,
+        (1 << JOYSTICK_CHANNEL_X) | (1 << JOYSTICK_CHANNEL_Y), JOYSTICK_SCAN_RATE_HZ) != MCP3008_SUCCESS) {
+        fprintf(stderr, "Failed to start joystick scan\n");
+        return 1;
+    }
 
-        // Update player position based on joystick direction
-        updatePosition(&matrixX, &matrixY, dir);
+    joystick_input_init(&joystick, &joystickScan, JOYSTICK_CHANNEL_X, JOYSTICK_CHANNEL_Y);
+    if (joystick_input_start(&joystick) != JOYSTICK_INPUT_SUCCESS) {
+        fprintf(stderr, "Failed to calibrate joystick\n");
+        mcp3008_scan_stop(&joystickScan);
+        return 1;
+    }
 
-        // Check for collision with food
-        checkFoodCollision();
+    // Game loop: every timer tick reads the input and advances the game by one step; frames are capped at 50 fps
+    game_timer_t tick;
+    if (game_timer_start(&tick, SIM_TICK_NS) != GAME_TIMER_SUCCESS) {
+        fprintf(stderr, "Failed to start game timer\n");
+        joystick_input_stop(&joystick);
+        mcp3008_scan_stop(&joystickScan);
+        return 1;
+    }
 
-        // Draw food on matrix
-        drawFood();
+    uint64_t frames = 0;
+    uint64_t lateTicks = 0;
+    int ticksSinceRender = RENDER_TICKS;
+    while (running) {
+        int due = game_timer_wait(&tick);
+        if (due < 0) {
+            break;
+        }
+        if (due > 1) {
+            lateTicks += due - 1;
+        }
+        if (due > MAX_CATCHUP_TICKS) {
+            due = MAX_CATCHUP_TICKS;
+        }
 
-        // Draw new player position
-        lightPixel(matrixX, matrixY);
+        uint64_t loopStart = nowNs();
+        readInput();
+        for (int i = 0; i < due && running; i++) {
+            simulateStep();
+        }
 
-        // Spawn food if needed
-        maybeSpawnFood();
+        ticksSinceRender += due;
+        if (ticksSinceRender >= RENDER_TICKS || !running) {
+            renderFrame();
+            ticksSinceRender = 0;
+            frames++;
+        }
 
-        // Win condition: all food collected
-        if (foodRemaining == 0) {
-            showWinMatrix();
-            foodRemaining = 0;
-            memset(foodMatrix, 0, sizeof(foodMatrix));
-            running = false;
+        if (loopTimeCount < MAX_LOOP_SAMPLES) {
+            loopTimes[loopTimeCount++] = (uint32_t)(nowNs() - loopStart);
         }
+    }
+
+    game_timer_stop(&tick);
+    max7219_flush_wait(&matrix);
 
-        usleep(100000); // Delay for stability (100ms)
+    if (gameWon) {
+        showWinMatrix();
     }
+    printf("Steps: %llu, frames: %llu, late ticks: %llu\n",
+           (unsigned long long)stepCount, (unsigned long long)frames, (unsigned long long)lateTicks);
+    printLoopTimes();
+    joystick_input_stop(&joystick);
+    mcp3008_scan_stop(&joystickScan);
+
+#ifndef JOYSTICKGAME_HEADLESS
+    // Time each class spent waiting for the bus (the stand-ins have no bus to wait for)
+    rpi_spi_latency_stats_t stats;
+    rpi_spi_get_latency_stats(JOYSTICK_BUS, SPI_PRIORITY_REALTIME, &stats);
+    printf("Joystick SPI latency: p50 %llu us, p99 %llu us, max %llu us\n",
+           (unsigned long long)stats.p50_ns / 1000, (unsigned long long)stats.p99_ns / 1000, (unsigned long long)stats.max_ns / 1000);
+    rpi_spi_get_latency_stats(MATRIX_BUS, SPI_PRIORITY_BULK, &stats);
+    printf("Matrix SPI latency:   p50 %llu us, p99 %llu us, max %llu us\n",
+           (unsigned long long)stats.p50_ns / 1000, (unsigned long long)stats.p99_ns / 1000, (unsigned long long)stats.max_ns / 1000);
+#else
+    standin_report();
+#endif
 
     return 0;
 }
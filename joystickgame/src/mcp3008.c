@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "mcp3008.h"
+
+// MCP3008 SPI command bits
+#define MCP3008_START_BIT      0x01
+#define MCP3008_SGL_DIFF       0x08  // Single-ended mode
+#define MCP3008_DONT_CARE      0x00
+
+#define RING_MASK (MCP3008_RING_SIZE - 1)
+
+// Pause between free-running scans of a failing device: doubles from the first to the last
+#define SCAN_BACKOFF_MIN_NS 1000000ULL
+#define SCAN_BACKOFF_MAX_NS 100000000ULL
+
+_Static_assert((MCP3008_RING_SIZE & RING_MASK) == 0, "MCP3008_RING_SIZE must be a power of two");
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Build one conversion per channel; each needs its own CS pulse to start */
+static unsigned build_segments(uint8_t channel_mask, rpi_spi_segment_t *segments,
+                               uint8_t tx[][3], uint8_t rx[][3])
+{
+    unsigned count = 0;
+
+    for (uint8_t channel = 0; channel < MCP3008_CHANNELS; channel++)
+    {
+        if (!(channel_mask & (1 << channel)))
+        {
+            continue;
+        }
+
+        tx[count][0] = MCP3008_START_BIT;
+        tx[count][1] = (MCP3008_SGL_DIFF | channel) << 4;
+        tx[count][2] = MCP3008_DONT_CARE;
+        segments[count] = (rpi_spi_segment_t){
+            .tx = tx[count],
+            .rx = rx[count],
+            .len = 3,
+            .flags = SPI_SEGMENT_CS_DEASSERT};
+        count++;
+    }
+
+    return count;
+}
+
+/* Extract the 10-bit results of a scan */
+static void decode_results(uint8_t channel_mask, uint8_t rx[][3], uint16_t *value)
+{
+    unsigned i = 0;
+
+    for (uint8_t channel = 0; channel < MCP3008_CHANNELS; channel++)
+    {
+        if (channel_mask & (1 << channel))
+        {
+            value[channel] = ((rx[i][1] & 0x03) << 8) | rx[i][2];
+            i++;
+        }
+    }
+}
+
+int mcp3008_init(mcp3008_t *adc, unsigned bus, unsigned device, uint32_t speed_hz)
+{
+    if (adc == NULL || speed_hz == 0 || speed_hz > MCP3008_MAX_SPEED_HZ)
+    {
+        return MCP3008_ERROR_BAD_ARGUMENT;
+    }
+
+    adc->bus = bus;
+    adc->device = device;
+
+    if (rpi_spi_configure_device(bus, device,
+                                 SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0,
+                                 speed_hz) != SPI_SUCCESS)
+    {
+        return MCP3008_ERROR_OPERATION_FAILED;
+    }
+
+    return MCP3008_SUCCESS;
+}
+
+int mcp3008_read_channels(const mcp3008_t *adc, uint8_t channel_mask, uint16_t value[MCP3008_CHANNELS])
+{
+    rpi_spi_segment_t segments[MCP3008_CHANNELS];
+    uint8_t tx[MCP3008_CHANNELS][3];
+    uint8_t rx[MCP3008_CHANNELS][3];
+
+    if (adc == NULL || value == NULL || channel_mask == 0)
+    {
+        return MCP3008_ERROR_BAD_ARGUMENT;
+    }
+
+    unsigned count = build_segments(channel_mask, segments, tx, rx);
+    if (rpi_spi_transfer_list(adc->bus, adc->device, segments, count) != SPI_SUCCESS)
+    {
+        return MCP3008_ERROR_OPERATION_FAILED;
+    }
+
+    decode_results(channel_mask, rx, value);
+    return MCP3008_SUCCESS;
+}
+
+/* Producer side of the ring: never blocks, drops the scan if the consumer is a full ring behind */
+static void ring_push(mcp3008_scan_t *scan, const mcp3008_sample_t *sample)
+{
+    unsigned head = atomic_load_explicit(&scan->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&scan->tail, memory_order_acquire);
+
+    if (head - tail >= MCP3008_RING_SIZE)
+    {
+        atomic_fetch_add_explicit(&scan->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    scan->ring[head & RING_MASK] = *sample;
+    atomic_store_explicit(&scan->head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&scan->scans, 1, memory_order_relaxed);
+}
+
+static void *scan_thread(void *arg)
+{
+    mcp3008_scan_t *scan = arg;
+    uint64_t next = now_ns();
+    uint64_t backoff_ns = 0;
+
+    while (atomic_load_explicit(&scan->running, memory_order_relaxed))
+    {
+        mcp3008_sample_t sample = {0};
+
+        if (rpi_spi_transfer_list(scan->adc->bus, scan->adc->device, scan->segments, scan->segment_count) == SPI_SUCCESS)
+        {
+            sample.timestamp_ns = now_ns();
+            decode_results(scan->channel_mask, scan->rx, sample.value);
+            ring_push(scan, &sample);
+            backoff_ns = 0;
+        }
+        else
+        {
+            atomic_fetch_add_explicit(&scan->errors, 1, memory_order_relaxed);
+            backoff_ns = backoff_ns ? backoff_ns * 2 : SCAN_BACKOFF_MIN_NS;
+            if (backoff_ns > SCAN_BACKOFF_MAX_NS)
+            {
+                backoff_ns = SCAN_BACKOFF_MAX_NS;
+            }
+        }
+
+        if (scan->period_ns == 0)
+        {
+            // Without a period, only a failing device is waited for, so that the thread does not spin on it
+            if (backoff_ns != 0)
+            {
+                struct timespec pause = {
+                    .tv_sec = backoff_ns / 1000000000ULL,
+                    .tv_nsec = backoff_ns % 1000000000ULL};
+                nanosleep(&pause, NULL);
+            }
+            continue;
+        }
+
+        // Keep the scan grid free of drift, skipping periods that have already passed
+        uint64_t now = now_ns();
+        next += scan->period_ns;
+        if (next <= now)
+        {
+            uint64_t missed = (now - next) / scan->period_ns + 1;
+            next += missed * scan->period_ns;
+            atomic_fetch_add_explicit(&scan->overruns, missed, memory_order_relaxed);
+        }
+
+        struct timespec deadline = {
+            .tv_sec = next / 1000000000ULL,
+            .tv_nsec = next % 1000000000ULL};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+        {
+        }
+    }
+
+    return NULL;
+}
+
+int mcp3008_scan_start(mcp3008_scan_t *scan, const mcp3008_t *adc, uint8_t channel_mask, uint32_t rate_hz)
+{
+    if (scan == NULL || adc == NULL || channel_mask == 0)
+    {
+        return MCP3008_ERROR_BAD_ARGUMENT;
+    }
+
+    memset(scan, 0, sizeof(*scan));
+    scan->adc = adc;
+    scan->channel_mask = channel_mask;
+    scan->period_ns = rate_hz ? 1000000000ULL / rate_hz : 0;
+    scan->segment_count = build_segments(channel_mask, scan->segments, scan->tx, scan->rx);
+
+    atomic_init(&scan->head, 0);
+    atomic_init(&scan->tail, 0);
+    atomic_init(&scan->scans, 0);
+    atomic_init(&scan->dropped, 0);
+    atomic_init(&scan->overruns, 0);
+    atomic_init(&scan->errors, 0);
+    atomic_init(&scan->running, true);
+
+    if (pthread_create(&scan->thread, NULL, scan_thread, scan) != EOK)
+    {
+        perror("pthread_create");
+        atomic_store(&scan->running, false);
+        return MCP3008_ERROR_THREAD;
+    }
+
+    return MCP3008_SUCCESS;
+}
+
+unsigned mcp3008_scan_read(mcp3008_scan_t *scan, mcp3008_sample_t *samples, unsigned max_samples)
+{
+    unsigned tail = atomic_load_explicit(&scan->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&scan->head, memory_order_acquire);
+    unsigned count = head - tail;
+
+    if (count > max_samples)
+    {
+        count = max_samples;
+    }
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        samples[i] = scan->ring[(tail + i) & RING_MASK];
+    }
+
+    // Hand the slots back to the producer only after they have been copied
+    atomic_store_explicit(&scan->tail, tail + count, memory_order_release);
+
+    return count;
+}
+
+void mcp3008_scan_get_stats(mcp3008_scan_t *scan, mcp3008_scan_stats_t *stats)
+{
+    stats->scans = atomic_load_explicit(&scan->scans, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&scan->dropped, memory_order_relaxed);
+    stats->overruns = atomic_load_explicit(&scan->overruns, memory_order_relaxed);
+    stats->errors = atomic_load_explicit(&scan->errors, memory_order_relaxed);
+}
+
+void mcp3008_scan_stop(mcp3008_scan_t *scan)
+{
+    if (atomic_exchange(&scan->running, false))
+    {
+        pthread_join(scan->thread, NULL);
+    }
+}
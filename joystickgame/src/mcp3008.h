@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MCP3008_H
+#define MCP3008_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "rpi_spi.h"
+
+/* Return codes for client API */
+#define MCP3008_SUCCESS 0
+#define MCP3008_ERROR_BAD_ARGUMENT -1
+#define MCP3008_ERROR_OPERATION_FAILED -2
+#define MCP3008_ERROR_THREAD -3
+
+#define MCP3008_CHANNELS 8
+#define MCP3008_MAX_VALUE 1023
+#define MCP3008_MAX_SPEED_HZ 3600000 // at VDD = 5V, 1.35 MHz at 2.7V
+
+#define MCP3008_RING_SIZE 1024 // samples, must be a power of two
+
+/* An MCP3008 on an SPI chip select */
+typedef struct
+{
+    unsigned bus;            // SPI bus number
+    unsigned device;         // SPI device (chip select) number
+} mcp3008_t;
+
+/* One scan of the configured channels */
+typedef struct
+{
+    uint64_t timestamp_ns;               // CLOCK_MONOTONIC time at which the scan completed
+    uint16_t value[MCP3008_CHANNELS];    // 10-bit result, indexed by channel (scanned channels only)
+} mcp3008_sample_t;
+
+/* Scan engine statistics */
+typedef struct
+{
+    uint64_t scans;          // scans written to the ring
+    uint64_t dropped;        // scans lost because the ring was full
+    uint64_t overruns;       // scan periods missed because the bus could not keep up
+    uint64_t errors;         // failed SPI transfers
+} mcp3008_scan_stats_t;
+
+/*
+ * Continuous scan engine: a dedicated thread scans a set of channels at a
+ * fixed rate and writes the samples into a single-producer/single-consumer
+ * ring. Exactly one consumer thread may call mcp3008_scan_read().
+ */
+typedef struct
+{
+    const mcp3008_t *adc;
+    uint8_t channel_mask;                        // bit n set: channel n is scanned
+    uint64_t period_ns;                          // time between scans, 0 to scan back to back
+
+    // Transfer list of one scan, built once on start
+    unsigned segment_count;
+    rpi_spi_segment_t segments[MCP3008_CHANNELS];
+    uint8_t tx[MCP3008_CHANNELS][3];
+    uint8_t rx[MCP3008_CHANNELS][3];
+
+    mcp3008_sample_t ring[MCP3008_RING_SIZE];
+    atomic_uint head;                            // next slot written, owned by the scan thread
+    atomic_uint tail;                            // next slot read, owned by the consumer
+
+    atomic_ullong scans;
+    atomic_ullong dropped;
+    atomic_ullong overruns;
+    atomic_ullong errors;
+
+    atomic_bool running;
+    pthread_t thread;
+} mcp3008_scan_t;
+
+/**
+ * Configure the SPI device for the MCP3008 (mode 0, MSB first)
+ *
+ * @param    adc         ADC description (output)
+ * @param    bus         SPI bus number
+ * @param    device      SPI device number
+ * @param    speed_hz    SPI clock, at most MCP3008_MAX_SPEED_HZ
+ *
+ * @returns  MCP3008_SUCCESS                 on success,
+ *           MCP3008_ERROR_BAD_ARGUMENT      invalid pointer or clock speed
+ *           MCP3008_ERROR_OPERATION_FAILED  SPI operation failed
+ */
+int mcp3008_init(mcp3008_t *adc, unsigned bus, unsigned device, uint32_t speed_hz);
+
+/**
+ * Read a set of single-ended channels with one transfer list
+ *
+ * @param    adc             ADC description
+ * @param    channel_mask    bit n set: read channel n
+ * @param    value           10-bit results indexed by channel (output)
+ *
+ * @returns  MCP3008_SUCCESS                 on success,
+ *           MCP3008_ERROR_BAD_ARGUMENT      invalid pointer or empty channel mask
+ *           MCP3008_ERROR_OPERATION_FAILED  SPI operation failed
+ */
+int mcp3008_read_channels(const mcp3008_t *adc, uint8_t channel_mask, uint16_t value[MCP3008_CHANNELS]);
+
+/**
+ * Start scanning a set of channels on a dedicated thread. The achievable rate
+ * is bounded by the SPI clock (24 clocks per channel) and the devctl per
+ * conversion; missed periods are counted as overruns.
+ *
+ * @param    scan            scan engine state (output), must stay valid until stopped
+ * @param    adc             ADC description
+ * @param    channel_mask    bit n set: scan channel n
+ * @param    rate_hz         scans per second, 0 to scan as fast as possible
+ *                           (a failing device is retried after 1 to 100ms)
+ *
+ * @returns  MCP3008_SUCCESS                 on success,
+ *           MCP3008_ERROR_BAD_ARGUMENT      invalid pointer or empty channel mask
+ *           MCP3008_ERROR_THREAD            the scan thread could not be created
+ */
+int mcp3008_scan_start(mcp3008_scan_t *scan, const mcp3008_t *adc, uint8_t channel_mask, uint32_t rate_hz);
+
+/**
+ * Take up to max_samples of the oldest samples from the ring, without blocking
+ *
+ * @param    scan            scan engine state
+ * @param    samples         sample buffer (output)
+ * @param    max_samples     size of the sample buffer
+ *
+ * @returns  the number of samples copied
+ */
+unsigned mcp3008_scan_read(mcp3008_scan_t *scan, mcp3008_sample_t *samples, unsigned max_samples);
+
+/**
+ * Read the scan engine statistics
+ *
+ * @param    scan            scan engine state
+ * @param    stats           statistics (output)
+ */
+void mcp3008_scan_get_stats(mcp3008_scan_t *scan, mcp3008_scan_stats_t *stats);
+
+/**
+ * Stop the scan thread. Samples still in the ring can be read afterwards.
+ *
+ * @param    scan            scan engine state
+ */
+void mcp3008_scan_stop(mcp3008_scan_t *scan);
+
+#endif
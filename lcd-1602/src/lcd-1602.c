@@ -2,33 +2,27 @@
 #include <stdint.h>
 #include <string.h>
 #include <unistd.h>
-#include "rpi_i2c.h"  // I2C API functions for Raspberry Pi or QNX
+#include <time.h>
+#include "lcd.h"          // HD44780 LCD driver and framebuffer
+#include "lcd_service.h"  // Background LCD render thread
 
-// I2C address for the PCF8574 I/O expander (controls the LCD)
-#define I2C_ADDR 0x27
-#define BUS 1  // I2C bus number
+// Maximum LCD refresh rate of the render service
+#define LCD_MAX_FPS 20
 
-// LCD configuration
-#define LCD_WIDTH 16        // Characters per line
-#define LCD_CHR 1           // Sending data
-#define LCD_CMD 0           // Sending command
-#define LCD_LINE_1 0x80     // Address for line 1
-#define LCD_LINE_2 0xC0     // Address for line 2
-#define ENABLE 0b00000100   // Enable bit for toggling
+// Character code of the fully lit cell in the HD44780 character ROM
+#define LCD_FULL_BLOCK 0xFF
 
-// Backlight control (0x08 = on, 0x00 = off)
-uint8_t LCD_BACKLIGHT = 0x00;
-
-// Delay constants (in microseconds)
-#define E_PULSE_US 500
-#define E_DELAY_US 500
+// Partially filled bar graph cells: 1 to 4 of the 5 pixel columns lit
+static const lcd_glyph_t BAR_GLYPHS[4] = {
+    {{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10}},
+    {{0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18}},
+    {{0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C}},
+    {{0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E}},
+};
 
 // Function declarations
-void lcd_toggle_enable(uint8_t bits);
-void lcd_byte(uint8_t bits, uint8_t mode);
-void lcd_init();
-void lcd_string(const char *message, uint8_t line);
-void marquee_smooth(const char *message, uint8_t line, int delay_ms, int cycles);
+void marquee_smooth(lcd_fb_t *fb, const char *message, unsigned row, int delay_ms, int cycles);
+void bar_graph(lcd_fb_t *fb, lcd_glyph_cache_t *glyphs, unsigned row, int delay_ms);
 
 int main() {
     // Initialize the LCD
@@ -37,88 +31,94 @@ int main() {
     // Enable backlight
     LCD_BACKLIGHT = 0x08;
 
+    // The display was just cleared, so the framebuffer starts in sync with it
+    lcd_fb_t fb;
+    lcd_fb_init(&fb, LCD_WIDTH, 2);
+
     // Display messages
-    lcd_string("Hello, world!", LCD_LINE_1);
-    marquee_smooth("C on QNX!", LCD_LINE_2, 300, 3);
+    lcd_fb_line(&fb, 0, "Hello, world!");
+    lcd_fb_flush(&fb);
+    marquee_smooth(&fb, "C on QNX!", 1, 300, 3);
+
+    // Sweep a bar graph built from custom characters up and down the second line
+    lcd_glyph_cache_t glyphs;
+    lcd_glyph_cache_init(&glyphs);
+    bar_graph(&fb, &glyphs, 1, 20);
+
+    // Hand the display to the render thread: updates below never wait for the bus
+    lcd_service_t lcd;
+    if (lcd_service_start(&lcd, &fb, LCD_MAX_FPS) != LCD_SERVICE_SUCCESS) {
+        fprintf(stderr, "Failed to start LCD service\n");
+        lcd_cleanup();
+        return 1;
+    }
 
-    // Wait and then clear the screen
-    sleep(5);
+    // Show a running timer for 5 seconds, updated far faster than the refresh cap;
+    // the service coalesces the updates and only sends the digits that changed
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        char status[LCD_WIDTH + 1];
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed_ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+        snprintf(status, sizeof(status), "Time: %ld.%03lds", elapsed_ms / 1000, elapsed_ms % 1000);
+        lcd_service_line(&lcd, 1, status);
+        lcd_service_request_flush(&lcd);
+        usleep(1000);
+    } while (now.tv_sec - start.tv_sec < 5);
+
+    lcd_service_stop(&lcd, &fb);
+    printf("LCD updates requested: %llu, frames sent: %llu\n",
+           (unsigned long long)lcd.requests, (unsigned long long)lcd.frames);
+
+    // Clear the screen
     LCD_BACKLIGHT = 0x00;
     lcd_byte(0x01, LCD_CMD);  // Clear display
 
     // Clean up I2C
-    smbus_cleanup(BUS);
+    lcd_cleanup();
     return 0;
 }
 
-// Initialize the LCD with standard commands
-void lcd_init() {
-    lcd_byte(0b00110011, LCD_CMD); // Initialization step 1
-    lcd_byte(0b00110010, LCD_CMD); // Initialization step 2
-    lcd_byte(0b00000110, LCD_CMD); // Set cursor move direction
-    lcd_byte(0b00001100, LCD_CMD); // Display ON, cursor OFF, blink OFF
-    lcd_byte(0b00101000, LCD_CMD); // Function set: 2 lines, 5x8 font
-    lcd_byte(0b00000001, LCD_CMD); // Clear display
-    usleep(E_DELAY_US);            // Short delay
-}
-
-// Send byte to LCD (as command or data), split into two 4-bit transfers
-void lcd_byte(uint8_t bits, uint8_t mode) {
-    uint8_t bits_high = mode | (bits & 0xF0) | LCD_BACKLIGHT;
-    uint8_t bits_low = mode | ((bits << 4) & 0xF0) | LCD_BACKLIGHT;
+// Scrolling marquee text using the display shift instruction: one command byte per step
+void marquee_smooth(lcd_fb_t *fb, const char *message, unsigned row, int delay_ms, int cycles) {
+    lcd_marquee_t marquee;
+    lcd_marquee_start(&marquee, fb, row, message);
 
-    smbus_write_byte_data(BUS, I2C_ADDR, 0, bits_high);
-    lcd_toggle_enable(bits_high);
-
-    smbus_write_byte_data(BUS, I2C_ADDR, 0, bits_low);
-    lcd_toggle_enable(bits_low);
-}
-
-// Toggle the enable bit to latch data into the LCD
-void lcd_toggle_enable(uint8_t bits) {
-    usleep(E_DELAY_US);
-    smbus_write_byte_data(BUS, I2C_ADDR, 0, bits | ENABLE);
-    usleep(E_PULSE_US);
-    smbus_write_byte_data(BUS, I2C_ADDR, 0, bits & ~ENABLE);
-    usleep(E_DELAY_US);
-}
-
-// Display a string on a specified LCD line
-void lcd_string(const char *message, uint8_t line) {
-    char padded[LCD_WIDTH + 1];
-    int len = strlen(message);
-
-    // Pad or truncate message to LCD width
-    for (int i = 0; i < LCD_WIDTH; i++) {
-        if (i < len) {
-            padded[i] = message[i];
-        } else {
-            padded[i] = ' ';
+    for (int c = 0; c < cycles; c++) {
+        for (int pos = 0; pos < LCD_DDRAM_LINE_LEN; pos++) {
+            usleep(delay_ms * 1000);  // Delay between shifts
+            lcd_marquee_step(&marquee);
         }
     }
-    padded[LCD_WIDTH] = '\0';  // Safe null-termination
 
-    lcd_byte(line, LCD_CMD);  // Set cursor position
-    for (int i = 0; i < LCD_WIDTH; i++) {
-        lcd_byte(padded[i], LCD_CHR);  // Send each character
-    }
+    lcd_marquee_stop(&marquee);
 }
 
-// Smooth scrolling marquee text across a single LCD line
-void marquee_smooth(const char *message, uint8_t line, int delay_ms, int cycles) {
-    int msg_len = strlen(message);
-    char scroll_text[64];  // Buffer to hold scrollable text
-    snprintf(scroll_text, sizeof(scroll_text), "%-*s", msg_len + LCD_WIDTH, message); // Pad with spaces
-
-    for (int c = 0; c < cycles; c++) {
-        for (int pos = 0; pos < msg_len + LCD_WIDTH; pos++) {
-            char window[LCD_WIDTH + 1];
-            for (int i = 0; i < LCD_WIDTH; i++) {
-                window[i] = scroll_text[(pos + i) % (msg_len + LCD_WIDTH)];
+// Draw a bar of `level` pixel columns; each step rewrites only the cell at the end of the bar
+void bar_graph(lcd_fb_t *fb, lcd_glyph_cache_t *glyphs, unsigned row, int delay_ms) {
+    int max_level = LCD_WIDTH * 5;
+
+    for (int step = 0; step <= 2 * max_level; step++) {
+        int level = step <= max_level ? step : 2 * max_level - step;
+        char line[LCD_WIDTH + 1];
+
+        for (int i = 0; i < LCD_WIDTH; i++) {
+            int lit = level - i * 5;
+            if (lit >= 5) {
+                line[i] = (char)LCD_FULL_BLOCK;
+            } else if (lit > 0) {
+                // The partial glyph is uploaded to CGRAM only the first time it is needed
+                int code = lcd_glyph_acquire(glyphs, fb, &BAR_GLYPHS[lit - 1]);
+                line[i] = code >= 0 ? (char)code : ' ';
+            } else {
+                line[i] = ' ';
             }
-            window[LCD_WIDTH] = '\0';
-            lcd_string(window, line);
-            usleep(delay_ms * 1000);  // Delay between shifts
         }
+        line[LCD_WIDTH] = '\0';
+
+        lcd_fb_line(fb, row, line);
+        lcd_fb_flush(fb);
+        usleep(delay_ms * 1000);
     }
 }
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include "rpi_i2c.h"  // I2C API functions for Raspberry Pi or QNX
+#include "lcd.h"
+
+#define ENABLE 0b00000100   // Enable bit for toggling
+
+// Delay constants (in microseconds)
+#define LCD_POWER_ON_US  50000  // Wait after power on before the first instruction
+#define LCD_INIT_US      5000   // Wait after the first "8-bit mode" nibble of the init sequence
+#define LCD_NIBBLE_US    150    // Wait after the following init nibbles
+#define LCD_CLEAR_US     2000   // Clear display and return home take 1.52 ms
+
+// Each LCD byte is sent as four expander states
+#define LCD_STATES_PER_BYTE 4
+
+// Largest number of LCD bytes packed into a single I2C write (block size is limited to 255 bytes)
+#define LCD_MAX_PACKED_BYTES (255 / LCD_STATES_PER_BYTE)
+
+// Cursor/display shift instruction: shift the display to the left
+#define LCD_SHIFT_DISPLAY_LEFT 0b00011000
+#define LCD_RETURN_HOME        0b00000010
+#define LCD_SET_CGRAM_ADDR     0b01000000
+
+// Unchanged cells between two changed ones that are cheaper to rewrite than to skip with a new DDRAM address
+#define LCD_FB_MAX_GAP 1
+
+// DDRAM address of the first character of each row
+static const uint8_t LCD_ROW_ADDR[LCD_MAX_ROWS] = {0x00, 0x40, 0x14, 0x54};
+
+// Backlight control (0x08 = on, 0x00 = off)
+uint8_t LCD_BACKLIGHT = 0x00;
+
+/*
+ * Encode a byte as the four expander states that strobe both nibbles into the
+ * LCD: high nibble with E set, high nibble with E clear, then the same for the
+ * low nibble. Each state takes a full I2C byte time (about 90 us at 100 kHz),
+ * which already exceeds the 450 ns enable pulse width and the 37 us execution
+ * time of ordinary instructions.
+ */
+static uint8_t *lcd_encode(uint8_t *out, uint8_t bits, uint8_t mode)
+{
+    uint8_t bits_high = mode | (bits & 0xF0) | LCD_BACKLIGHT;
+    uint8_t bits_low = mode | ((bits << 4) & 0xF0) | LCD_BACKLIGHT;
+
+    *out++ = bits_high | ENABLE;
+    *out++ = bits_high;
+    *out++ = bits_low | ENABLE;
+    *out++ = bits_low;
+
+    return out;
+}
+
+// Strobe a single nibble; only used by the init sequence, which needs waits between nibbles
+static void lcd_nibble(uint8_t bits)
+{
+    uint8_t states[2] = {(bits & 0xF0) | LCD_BACKLIGHT | ENABLE, (bits & 0xF0) | LCD_BACKLIGHT};
+
+    smbus_write_block(LCD_BUS, LCD_I2C_ADDR, states, sizeof(states));
+}
+
+// Send an optional DDRAM address command followed by characters, packed into as few I2C writes as possible
+static void lcd_write_run(int cmd, const char *chars, unsigned count)
+{
+    uint8_t states[LCD_MAX_PACKED_BYTES * LCD_STATES_PER_BYTE];
+
+    while (cmd >= 0 || count > 0)
+    {
+        uint8_t *out = states;
+        unsigned room = LCD_MAX_PACKED_BYTES;
+
+        if (cmd >= 0)
+        {
+            out = lcd_encode(out, (uint8_t)cmd, LCD_CMD);
+            room--;
+            cmd = -1;
+        }
+
+        for (; count > 0 && room > 0; count--, room--)
+        {
+            out = lcd_encode(out, (uint8_t)*chars++, LCD_CHR);
+        }
+
+        smbus_write_block(LCD_BUS, LCD_I2C_ADDR, states, out - states);
+    }
+}
+
+void lcd_init()
+{
+    usleep(LCD_POWER_ON_US);
+
+    // Reset into 4-bit mode: three "8-bit mode" nibbles, then "4-bit mode"
+    lcd_nibble(0b00110000);
+    usleep(LCD_INIT_US);
+    lcd_nibble(0b00110000);
+    usleep(LCD_NIBBLE_US);
+    lcd_nibble(0b00110000);
+    usleep(LCD_NIBBLE_US);
+    lcd_nibble(0b00100000);
+    usleep(LCD_NIBBLE_US);
+
+    lcd_byte(0b00101000, LCD_CMD); // Function set: 2 lines, 5x8 font
+    lcd_byte(0b00001100, LCD_CMD); // Display ON, cursor OFF, blink OFF
+    lcd_byte(0b00000110, LCD_CMD); // Set cursor move direction
+    lcd_byte(0b00000001, LCD_CMD); // Clear display
+}
+
+// Send the byte as one I2C write of four expander states
+void lcd_byte(uint8_t bits, uint8_t mode)
+{
+    uint8_t states[LCD_STATES_PER_BYTE];
+
+    lcd_encode(states, bits, mode);
+    smbus_write_block(LCD_BUS, LCD_I2C_ADDR, states, sizeof(states));
+
+    // Only clear display (0x01) and return home (0x02/0x03) take longer than an I2C write
+    if (mode == LCD_CMD && bits <= 0x03)
+    {
+        usleep(LCD_CLEAR_US);
+    }
+}
+
+void lcd_string(const char *message, uint8_t line)
+{
+    char padded[LCD_WIDTH + 1];
+    int len = strlen(message);
+
+    // Pad or truncate message to LCD width
+    for (int i = 0; i < LCD_WIDTH; i++)
+    {
+        if (i < len)
+        {
+            padded[i] = message[i];
+        }
+        else
+        {
+            padded[i] = ' ';
+        }
+    }
+    padded[LCD_WIDTH] = '\0';  // Safe null-termination
+
+    lcd_write_run(line, padded, LCD_WIDTH);  // Set cursor position and send the characters
+}
+
+void lcd_cleanup()
+{
+    smbus_cleanup(LCD_BUS);
+}
+
+void lcd_fb_init(lcd_fb_t *fb, unsigned cols, unsigned rows)
+{
+    fb->cols = cols > LCD_MAX_COLS ? LCD_MAX_COLS : cols;
+    fb->rows = rows > LCD_MAX_ROWS ? LCD_MAX_ROWS : rows;
+
+    // A cleared display shows spaces everywhere
+    memset(fb->shadow, ' ', sizeof(fb->shadow));
+    memset(fb->shown, ' ', sizeof(fb->shown));
+    fb->valid = true;
+}
+
+void lcd_fb_clear(lcd_fb_t *fb)
+{
+    memset(fb->shadow, ' ', sizeof(fb->shadow));
+}
+
+void lcd_fb_write(lcd_fb_t *fb, unsigned row, unsigned col, const char *text)
+{
+    if (row >= fb->rows)
+    {
+        return;
+    }
+
+    for (; col < fb->cols && *text != '\0'; col++, text++)
+    {
+        fb->shadow[row][col] = *text;
+    }
+}
+
+void lcd_fb_line(lcd_fb_t *fb, unsigned row, const char *text)
+{
+    if (row >= fb->rows)
+    {
+        return;
+    }
+
+    memset(fb->shadow[row], ' ', fb->cols);
+    lcd_fb_write(fb, row, 0, text);
+}
+
+void lcd_fb_invalidate(lcd_fb_t *fb)
+{
+    fb->valid = false;
+}
+
+/* Is the cell different from what the display shows */
+static bool lcd_fb_dirty(const lcd_fb_t *fb, unsigned row, unsigned col)
+{
+    return !fb->valid || fb->shadow[row][col] != fb->shown[row][col];
+}
+
+unsigned lcd_fb_flush(lcd_fb_t *fb)
+{
+    unsigned written = 0;
+
+    for (unsigned row = 0; row < fb->rows; row++)
+    {
+        unsigned col = 0;
+
+        while (col < fb->cols)
+        {
+            if (!lcd_fb_dirty(fb, row, col))
+            {
+                col++;
+                continue;
+            }
+
+            // Extend the run across short clean gaps; the cursor auto-increments after each character
+            unsigned start = col;
+            unsigned end = col + 1;
+            for (unsigned next = end; next < fb->cols && next <= end + LCD_FB_MAX_GAP; next++)
+            {
+                if (lcd_fb_dirty(fb, row, next))
+                {
+                    end = next + 1;
+                }
+            }
+
+            // Set DDRAM address and send the run in a single I2C write
+            lcd_write_run(0x80 | (LCD_ROW_ADDR[row] + start), &fb->shadow[row][start], end - start);
+            memcpy(&fb->shown[row][start], &fb->shadow[row][start], end - start);
+            col = end;
+
+            written += end - start;
+        }
+    }
+
+    fb->valid = true;
+
+    return written;
+}
+
+void lcd_marquee_start(lcd_marquee_t *marquee, lcd_fb_t *fb, unsigned row, const char *message)
+{
+    char line[LCD_DDRAM_LINE_LEN];
+    size_t len = strlen(message);
+
+    if (len > LCD_DDRAM_LINE_LEN)
+    {
+        len = LCD_DDRAM_LINE_LEN;
+    }
+    memset(line, ' ', sizeof(line));
+    memcpy(line, message, len);
+
+    marquee->fb = fb;
+    marquee->row = row < fb->rows ? row : 0;
+    marquee->offset = 0;
+
+    // Undo any previous shift, then write the full DDRAM line once
+    lcd_byte(LCD_RETURN_HOME, LCD_CMD);
+    lcd_write_run(0x80 | LCD_ROW_ADDR[marquee->row], line, sizeof(line));
+
+    // The unshifted window now shows the start of the line
+    memcpy(fb->shadow[marquee->row], line, fb->cols);
+    memcpy(fb->shown[marquee->row], line, fb->cols);
+}
+
+void lcd_marquee_step(lcd_marquee_t *marquee)
+{
+    lcd_byte(LCD_SHIFT_DISPLAY_LEFT, LCD_CMD);
+    marquee->offset = (marquee->offset + 1) % LCD_DDRAM_LINE_LEN;
+}
+
+void lcd_marquee_stop(lcd_marquee_t *marquee)
+{
+    // Return home resets the shift without touching DDRAM, so the framebuffer stays valid
+    lcd_byte(LCD_RETURN_HOME, LCD_CMD);
+    marquee->offset = 0;
+}
+
+void lcd_glyph_cache_init(lcd_glyph_cache_t *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+}
+
+/* Bit mask of the CGRAM slots referenced by the framebuffer, either drawn or still on the display */
+static uint8_t lcd_visible_slots(const lcd_fb_t *fb)
+{
+    uint8_t visible = 0;
+
+    for (unsigned row = 0; row < fb->rows; row++)
+    {
+        for (unsigned col = 0; col < fb->cols; col++)
+        {
+            uint8_t drawn = (uint8_t)fb->shadow[row][col];
+            uint8_t shown = (uint8_t)fb->shown[row][col];
+
+            // Codes 0x00-0x0F all map onto the eight slots
+            if (drawn < 0x10)
+            {
+                visible |= 1 << (drawn & 0x07);
+            }
+            if (shown < 0x10)
+            {
+                visible |= 1 << (shown & 0x07);
+            }
+        }
+    }
+
+    return visible;
+}
+
+int lcd_glyph_acquire(lcd_glyph_cache_t *cache, const lcd_fb_t *fb, const lcd_glyph_t *glyph)
+{
+    cache->clock++;
+
+    for (unsigned slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+    {
+        if (cache->resident[slot] == glyph)
+        {
+            cache->last_used[slot] = cache->clock;
+            cache->hits++;
+            return LCD_GLYPH_CHAR(slot);
+        }
+    }
+
+    // Prefer an empty slot, otherwise the least recently used one that is not visible
+    uint8_t visible = lcd_visible_slots(fb);
+    int victim = -1;
+
+    for (unsigned slot = 0; slot < LCD_CGRAM_SLOTS; slot++)
+    {
+        if (cache->resident[slot] == NULL)
+        {
+            victim = slot;
+            break;
+        }
+
+        if (!(visible & (1 << slot)) &&
+            (victim < 0 || cache->last_used[slot] < cache->last_used[victim]))
+        {
+            victim = slot;
+        }
+    }
+
+    if (victim < 0)
+    {
+        return -1;
+    }
+
+    // Set the CGRAM address and upload the eight pixel rows in a single I2C write
+    lcd_write_run(LCD_SET_CGRAM_ADDR | (victim << 3), (const char *)glyph->rows, sizeof(glyph->rows));
+
+    cache->resident[victim] = glyph;
+    cache->last_used[victim] = cache->clock;
+    cache->uploads++;
+
+    return LCD_GLYPH_CHAR(victim);
+}
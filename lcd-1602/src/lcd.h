@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LCD_H
+#define LCD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// I2C address for the PCF8574 I/O expander (controls the LCD)
+#define LCD_I2C_ADDR 0x27
+#define LCD_BUS 1  // I2C bus number
+
+// LCD configuration
+#define LCD_WIDTH 16        // Characters per line
+#define LCD_CHR 1           // Sending data
+#define LCD_CMD 0           // Sending command
+#define LCD_LINE_1 0x80     // Address for line 1
+#define LCD_LINE_2 0xC0     // Address for line 2
+
+// Largest display supported by the framebuffer (HD44780 DDRAM holds 80 characters)
+#define LCD_MAX_COLS 40
+#define LCD_MAX_ROWS 4
+
+// DDRAM cells per line; the display shows a window onto them that can be shifted
+#define LCD_DDRAM_LINE_LEN 40
+
+// Custom characters: eight CGRAM slots, shown with character codes 0x08-0x0F
+// (the controller also maps 0x00-0x07 to them, but 0x00 cannot appear in a string)
+#define LCD_CGRAM_SLOTS 8
+#define LCD_GLYPH_CHAR(slot) (0x08 + (slot))
+
+// Backlight control (0x08 = on, 0x00 = off)
+extern uint8_t LCD_BACKLIGHT;
+
+/*
+ * Shadow framebuffer for a WxH character display. Drawing only touches
+ * memory; lcd_fb_flush() compares the shadow against what the display is
+ * known to show and sends the DDRAM address plus the changed characters.
+ */
+typedef struct
+{
+    unsigned cols;                              // display width in characters
+    unsigned rows;                              // display height in characters
+    bool valid;                                 // false until the display content is known
+    char shadow[LCD_MAX_ROWS][LCD_MAX_COLS];    // what the application wants shown
+    char shown[LCD_MAX_ROWS][LCD_MAX_COLS];     // what the display currently shows
+} lcd_fb_t;
+
+/*
+ * Marquee scrolled by the HD44780 display shift instruction. The message is
+ * written to all 40 DDRAM cells of its line once; every step is then a single
+ * shift command. The controller shifts all lines together, so other lines
+ * scroll along while a marquee is running.
+ */
+typedef struct
+{
+    lcd_fb_t *fb;            // framebuffer kept in sync with the visible cells
+    unsigned row;            // row the message was written to
+    unsigned offset;         // current display shift, 0 to LCD_DDRAM_LINE_LEN - 1
+} lcd_marquee_t;
+
+/* A 5x8 custom character: one byte per pixel row, lowest 5 bits used */
+typedef struct
+{
+    uint8_t rows[8];
+} lcd_glyph_t;
+
+/*
+ * Maps any number of logical glyphs onto the eight CGRAM slots. A glyph is
+ * identified by the address of its bitmap; it is uploaded only when it is not
+ * already resident, replacing the least recently used slot that is not
+ * visible on the display.
+ */
+typedef struct
+{
+    const lcd_glyph_t *resident[LCD_CGRAM_SLOTS];   // glyph held by each slot, NULL if empty
+    uint32_t last_used[LCD_CGRAM_SLOTS];            // LRU timestamp of each slot
+    uint32_t clock;                                 // LRU clock, advanced on every acquire
+    uint32_t hits;                                  // acquires served without an upload
+    uint32_t uploads;                               // CGRAM uploads performed
+} lcd_glyph_cache_t;
+
+// Initialize the LCD with standard commands (leaves the display cleared)
+void lcd_init();
+
+// Send byte to LCD (as command or data)
+void lcd_byte(uint8_t bits, uint8_t mode);
+
+// Display a string on a specified LCD line, rewriting the whole line
+void lcd_string(const char *message, uint8_t line);
+
+// Release the I2C bus used by the LCD
+void lcd_cleanup();
+
+/**
+ * Initialize a framebuffer for a display that has just been cleared
+ *
+ * @param    fb      framebuffer
+ * @param    cols    display width, at most LCD_MAX_COLS
+ * @param    rows    display height, at most LCD_MAX_ROWS
+ */
+void lcd_fb_init(lcd_fb_t *fb, unsigned cols, unsigned rows);
+
+/**
+ * Fill the framebuffer with spaces
+ *
+ * @param    fb      framebuffer
+ */
+void lcd_fb_clear(lcd_fb_t *fb);
+
+/**
+ * Write text at a position, clipped to the end of the row
+ *
+ * @param    fb      framebuffer
+ * @param    row     row index
+ * @param    col     column index
+ * @param    text    text to write
+ */
+void lcd_fb_write(lcd_fb_t *fb, unsigned row, unsigned col, const char *text);
+
+/**
+ * Replace a whole row, padding with spaces or truncating to the display width
+ *
+ * @param    fb      framebuffer
+ * @param    row     row index
+ * @param    text    text to write
+ */
+void lcd_fb_line(lcd_fb_t *fb, unsigned row, const char *text);
+
+/**
+ * Forget what the display shows so the next flush rewrites every cell
+ *
+ * @param    fb      framebuffer
+ */
+void lcd_fb_invalidate(lcd_fb_t *fb);
+
+/**
+ * Send the cells that differ from what the display shows
+ *
+ * @param    fb      framebuffer
+ *
+ * @returns  the number of characters written to the display
+ */
+unsigned lcd_fb_flush(lcd_fb_t *fb);
+
+/**
+ * Write a message to the whole DDRAM line of a row, ready to be scrolled.
+ * Messages longer than LCD_DDRAM_LINE_LEN are truncated; shorter ones are
+ * padded with spaces, which form the gap between repetitions.
+ *
+ * @param    marquee  marquee state (output)
+ * @param    fb       framebuffer of the display
+ * @param    row      row index (0 or 1; four-line displays share DDRAM lines between rows)
+ * @param    message  text to scroll
+ */
+void lcd_marquee_start(lcd_marquee_t *marquee, lcd_fb_t *fb, unsigned row, const char *message);
+
+/**
+ * Scroll the display one cell to the left with a single shift command
+ *
+ * @param    marquee  marquee state
+ */
+void lcd_marquee_step(lcd_marquee_t *marquee);
+
+/**
+ * Return the display to its unshifted position
+ *
+ * @param    marquee  marquee state
+ */
+void lcd_marquee_stop(lcd_marquee_t *marquee);
+
+/**
+ * Initialize an empty glyph cache
+ *
+ * @param    cache   glyph cache
+ */
+void lcd_glyph_cache_init(lcd_glyph_cache_t *cache);
+
+/**
+ * Make a glyph resident in CGRAM and return the character code that shows it.
+ * Slots whose character appears in the framebuffer (drawn or still shown) are
+ * never replaced. Must be called by the owner of the framebuffer.
+ *
+ * @param    cache   glyph cache
+ * @param    fb      framebuffer of the display
+ * @param    glyph   glyph bitmap, must remain valid while it is resident
+ *
+ * @returns  the character code (LCD_GLYPH_CHAR(slot)) on success,
+ *           -1 if every slot holds a visible glyph
+ */
+int lcd_glyph_acquire(lcd_glyph_cache_t *cache, const lcd_fb_t *fb, const lcd_glyph_t *glyph);
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "lcd_service.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void *lcd_service_thread(void *arg)
+{
+    lcd_service_t *svc = arg;
+    uint64_t next_frame_ns = 0;
+
+    pthread_mutex_lock(&svc->mutex);
+
+    for (;;)
+    {
+        while (svc->running && !svc->pending)
+        {
+            pthread_cond_wait(&svc->cond, &svc->mutex);
+        }
+
+        if (!svc->pending)
+        {
+            break;
+        }
+
+        // Hold the frame until the interval has passed; requests arriving meanwhile join it
+        while (svc->running && now_ns() < next_frame_ns)
+        {
+            struct timespec ts = {
+                .tv_sec = next_frame_ns / 1000000000ULL,
+                .tv_nsec = next_frame_ns % 1000000000ULL};
+            pthread_cond_timedwait(&svc->cond, &svc->mutex, &ts);
+        }
+
+        // Take the frame; producers can keep drawing while it goes out on the bus
+        memcpy(svc->fb.shadow, svc->back, sizeof(svc->back));
+        svc->pending = false;
+        pthread_mutex_unlock(&svc->mutex);
+
+        uint64_t start_ns = now_ns();
+        lcd_fb_flush(&svc->fb);
+        next_frame_ns = start_ns + svc->frame_interval_ns;
+
+        pthread_mutex_lock(&svc->mutex);
+        svc->frames++;
+    }
+
+    pthread_mutex_unlock(&svc->mutex);
+
+    return NULL;
+}
+
+int lcd_service_start(lcd_service_t *svc, const lcd_fb_t *fb, unsigned max_fps)
+{
+    if (svc == NULL || fb == NULL || max_fps == 0)
+    {
+        return LCD_SERVICE_ERROR_BAD_ARGUMENT;
+    }
+
+    svc->fb = *fb;
+    memcpy(svc->back, fb->shadow, sizeof(svc->back));
+    svc->pending = false;
+    svc->running = true;
+    svc->frame_interval_ns = 1000000000ULL / max_fps;
+    svc->requests = 0;
+    svc->frames = 0;
+
+    pthread_mutex_init(&svc->mutex, NULL);
+
+    // Frame pacing is measured against the monotonic clock
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&svc->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&svc->thread, NULL, lcd_service_thread, svc) != EOK)
+    {
+        perror("pthread_create");
+        pthread_cond_destroy(&svc->cond);
+        pthread_mutex_destroy(&svc->mutex);
+        return LCD_SERVICE_ERROR_THREAD;
+    }
+
+    return LCD_SERVICE_SUCCESS;
+}
+
+void lcd_service_write(lcd_service_t *svc, unsigned row, unsigned col, const char *text)
+{
+    pthread_mutex_lock(&svc->mutex);
+
+    if (row < svc->fb.rows)
+    {
+        for (; col < svc->fb.cols && *text != '\0'; col++, text++)
+        {
+            svc->back[row][col] = *text;
+        }
+    }
+
+    pthread_mutex_unlock(&svc->mutex);
+}
+
+void lcd_service_line(lcd_service_t *svc, unsigned row, const char *text)
+{
+    char line[LCD_MAX_COLS + 1];
+
+    snprintf(line, sizeof(line), "%-*.*s", (int)svc->fb.cols, (int)svc->fb.cols, text);
+    lcd_service_write(svc, row, 0, line);
+}
+
+void lcd_service_request_flush(lcd_service_t *svc)
+{
+    pthread_mutex_lock(&svc->mutex);
+    svc->requests++;
+    svc->pending = true;
+    pthread_cond_signal(&svc->cond);
+    pthread_mutex_unlock(&svc->mutex);
+}
+
+void lcd_service_stop(lcd_service_t *svc, lcd_fb_t *fb)
+{
+    pthread_mutex_lock(&svc->mutex);
+    svc->running = false;
+    pthread_cond_signal(&svc->cond);
+    pthread_mutex_unlock(&svc->mutex);
+
+    pthread_join(svc->thread, NULL);
+
+    pthread_cond_destroy(&svc->cond);
+    pthread_mutex_destroy(&svc->mutex);
+
+    if (fb != NULL)
+    {
+        *fb = svc->fb;
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LCD_SERVICE_H
+#define LCD_SERVICE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "lcd.h"
+
+/* Return codes for client API */
+#define LCD_SERVICE_SUCCESS 0
+#define LCD_SERVICE_ERROR_BAD_ARGUMENT -1
+#define LCD_SERVICE_ERROR_THREAD -2
+
+/*
+ * LCD render service. Producers draw into a back buffer and request a flush
+ * without touching the bus; a service thread copies the back buffer into the
+ * framebuffer it owns and sends the changed cells. Requests arriving within
+ * one frame interval are coalesced into a single flush, which also caps the
+ * refresh rate.
+ */
+typedef struct
+{
+    lcd_fb_t fb;                                // front buffer, owned by the service thread
+    char back[LCD_MAX_ROWS][LCD_MAX_COLS];      // back buffer producers draw into
+    bool pending;                               // a flush was requested
+    bool running;
+    uint64_t frame_interval_ns;                 // minimum time between two flushes
+    uint64_t requests;                          // flush requests received
+    uint64_t frames;                            // flushes performed
+    pthread_mutex_t mutex;                      // protects the back buffer and the flags
+    pthread_cond_t cond;
+    pthread_t thread;
+} lcd_service_t;
+
+/**
+ * Start the service thread. The LCD must already be initialized; fb
+ * describes what the display currently shows.
+ *
+ * @param    svc      service state
+ * @param    fb       current framebuffer of the display (copied)
+ * @param    max_fps  maximum refresh rate in frames per second
+ *
+ * @returns  LCD_SERVICE_SUCCESS             on success,
+ *           LCD_SERVICE_ERROR_BAD_ARGUMENT  invalid pointer or zero refresh rate
+ *           LCD_SERVICE_ERROR_THREAD        the service thread could not be created
+ */
+int lcd_service_start(lcd_service_t *svc, const lcd_fb_t *fb, unsigned max_fps);
+
+/**
+ * Write text into the back buffer at a position, clipped to the end of the row
+ *
+ * @param    svc     service state
+ * @param    row     row index
+ * @param    col     column index
+ * @param    text    text to write
+ */
+void lcd_service_write(lcd_service_t *svc, unsigned row, unsigned col, const char *text);
+
+/**
+ * Replace a whole row of the back buffer, padding with spaces or truncating
+ *
+ * @param    svc     service state
+ * @param    row     row index
+ * @param    text    text to write
+ */
+void lcd_service_line(lcd_service_t *svc, unsigned row, const char *text);
+
+/**
+ * Ask the service thread to show the back buffer. Never blocks on the bus.
+ *
+ * @param    svc     service state
+ */
+void lcd_service_request_flush(lcd_service_t *svc);
+
+/**
+ * Perform any pending flush and stop the service thread
+ *
+ * @param    svc     service state
+ * @param    fb      framebuffer updated with what the display shows (optional)
+ */
+void lcd_service_stop(lcd_service_t *svc, lcd_fb_t *fb);
+
+#endif
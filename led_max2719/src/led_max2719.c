@@ -2,86 +2,59 @@
 #include <unistd.h>
 #include <stdint.h>
 #include "rpi_spi.h"
+#include "max7219.h"
+#include "max7219_gfx.h"
 
 // SPI configuration constants
 #define BUS 0
 #define DEVICE 0
 #define SPI_SPEED 10000000 // 10 MHz
+#define MODULES 1 // Number of 8x8 modules cascaded on the chip select
 
-// MAX7219 register addresses
-#define CMD_DIGIT0     0x01 // Base register for digit (row) control
-#define CMD_DECODEMODE 0x09 // BCD decode mode
-#define CMD_BRIGHTNESS 0x0A // Intensity control
-#define CMD_SCANLIMIT  0x0B // Number of digits to scan (0–7)
-#define CMD_SHUTDOWN   0x0C // Shutdown control
-#define CMD_DISPLAYTEST 0x0F // Display test mode
+// Heart sprite, one byte per row
+static const uint8_t HEART_BITS[] = {0x00, 0x66, 0xFF, 0xFF, 0x7E, 0x3C, 0x18, 0x00};
+static const gfx_sprite_t HEART = {.width = 8, .height = 8, .bits = HEART_BITS};
 
-// Sends a register/value pair to the MAX7219
-int max7219_send(uint8_t reg, uint8_t val) {
-    uint8_t buffer[2] = {reg, val};
-    if (rpi_spi_write_read_data(BUS, DEVICE, buffer, NULL, 2) != SPI_SUCCESS) {
-        fprintf(stderr, "Failed to send SPI data\n");
-        return 0;
-    }
-    return 1;
-}
+int main() {
 
-// Clears all 8 rows of the 8x8 matrix
-int max7219_clear() {
-    for (uint8_t i = 0; i < 8; i++) {
-        if (!max7219_send(CMD_DIGIT0 + i, 0x00)) {  // Turn off all LEDs in row `i`
-            fprintf(stderr, "Failed to clear display\n");
-            return 0;
-        }
+    // Initialize MAX7219 with low brightness
+    max7219_t matrix;
+    if (max7219_init(&matrix, BUS, DEVICE, MODULES, SPI_SPEED, 0x01) != MAX7219_SUCCESS) {
+        return 1;
     }
-    return 1;
-}
 
-// Initializes the MAX7219 chip for an 8x8 LED matrix
-// `intensity` sets the brightness (0x00 to 0x0F)
-int max7219_init(uint8_t intensity) {
-
-    // Configure SPI device with correct mode and speed
-    if (rpi_spi_configure_device(BUS, DEVICE,
-        SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0,
-        SPI_SPEED) != SPI_SUCCESS) {
-        fprintf(stderr, "Failed to configure SPI device\n");
-        return 0;
+    // Light up each row one by one briefly, across all modules; each flush only sends the rows that changed,
+    // and a row is a single transfer whatever the number of modules
+    for (int i = 0; i < MAX7219_ROWS; i++) {
+        max7219_fb_clear(&matrix);
+        for (int m = 0; m < MODULES; m++) {
+            max7219_fb_set_row(&matrix, m, i, 0xFF);  // Turn on all LEDs in row `i`
+        }
+        max7219_flush(&matrix);
+        usleep(100000);                        // Wait 100ms
     }
 
-    // Send startup configuration commands to MAX7219
-    if (!max7219_send(CMD_SHUTDOWN, 0) ||            // Enter shutdown mode
-        !max7219_send(CMD_DISPLAYTEST, 0) ||         // Disable display test
-        !max7219_send(CMD_SCANLIMIT, 7) ||           // Enable all 8 digits
-        !max7219_send(CMD_DECODEMODE, 0) ||          // No BCD decoding
-        !max7219_send(CMD_BRIGHTNESS, intensity) ||  // Set brightness
-        !max7219_send(CMD_SHUTDOWN, 1)) {            // Exit shutdown (turn on display)
+    // Turn off the last row
+    max7219_fb_clear(&matrix);
+    max7219_flush(&matrix);
 
-        fprintf(stderr, "Failed to send init command to MAX7219\n");
-        return 0;
+    // Scroll a message across the display: one shift of the row bytes and one flush per frame
+    gfx_scroll_t scroll;
+    gfx_scroll_init(&scroll, "Hello from QNX!");
+    while (!gfx_scroll_step(&matrix, &scroll)) {
+        max7219_flush(&matrix);
+        usleep(50000);  // 20 columns per second
     }
 
-    // Clear the display initially
-    if (!max7219_clear()) {
-        return 0;
+    // Show a heart on every module for a second
+    for (int m = 0; m < MODULES; m++) {
+        gfx_blit(&matrix, &HEART, m * MAX7219_COLS, 0, GFX_OP_SET);
     }
+    max7219_flush(&matrix);
+    sleep(1);
 
-    return 1;
-}
-
-int main() {
-
-    // Initialize MAX7219 with low brightness
-    if (!max7219_init(0x01)) {
-        return 1;
-    }
-
-    // Light up each row one by one briefly
-    for (int i = 0; i < 8; i++) {
-        max7219_send(CMD_DIGIT0 + i, 0xFF);  // Turn on all LEDs in row `i`
-        usleep(100000);                      // Wait 100ms
-        max7219_send(CMD_DIGIT0 + i, 0x00);  // Turn off row `i`
-    }
+    max7219_fb_clear(&matrix);
+    max7219_flush(&matrix);
 
     // Clean up SPI device
     rpi_spi_cleanup_device(BUS, DEVICE);
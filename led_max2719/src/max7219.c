@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "rpi_spi.h"
+#include "max7219.h"
+
+int max7219_send(max7219_t *matrix, uint8_t reg, uint8_t value)
+{
+    uint8_t buffer[2 * MAX7219_MAX_DEVICES];
+
+    // Keep register writes in order with a flush still being sent
+    max7219_flush_wait(matrix);
+
+    // Every module in the chain receives the same register write when CS rises
+    for (unsigned module = 0; module < matrix->count; module++)
+    {
+        buffer[2 * module] = reg;
+        buffer[2 * module + 1] = value;
+    }
+
+    if (rpi_spi_write_read_data(matrix->bus, matrix->device, buffer, NULL, 2 * matrix->count) != SPI_SUCCESS)
+    {
+        fprintf(stderr, "Failed to send SPI data\n");
+        return MAX7219_ERROR_OPERATION_FAILED;
+    }
+
+    return MAX7219_SUCCESS;
+}
+
+int max7219_init(max7219_t *matrix, unsigned bus, unsigned device, unsigned count, uint32_t speed_hz, uint8_t intensity)
+{
+    if (matrix == NULL || count < 1 || count > MAX7219_MAX_DEVICES || intensity > 0x0F)
+    {
+        return MAX7219_ERROR_BAD_ARGUMENT;
+    }
+
+    memset(matrix, 0, sizeof(*matrix));
+    matrix->bus = bus;
+    matrix->device = device;
+    matrix->count = count;
+
+    if (rpi_spi_configure_device(bus, device,
+                                 SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0,
+                                 speed_hz) != SPI_SUCCESS)
+    {
+        fprintf(stderr, "Failed to configure SPI device\n");
+        return MAX7219_ERROR_OPERATION_FAILED;
+    }
+
+    // Initialization sequence, then write every row from the (cleared) framebuffer
+    if (max7219_send(matrix, MAX7219_REG_SHUTDOWN, 0) != MAX7219_SUCCESS ||           // Enter shutdown
+        max7219_send(matrix, MAX7219_REG_DISPLAYTEST, 0) != MAX7219_SUCCESS ||        // Disable test mode
+        max7219_send(matrix, MAX7219_REG_SCANLIMIT, 7) != MAX7219_SUCCESS ||          // Enable all rows
+        max7219_send(matrix, MAX7219_REG_DECODEMODE, 0) != MAX7219_SUCCESS ||         // Use raw LED values
+        max7219_send(matrix, MAX7219_REG_INTENSITY, intensity) != MAX7219_SUCCESS ||  // Set brightness
+        max7219_send(matrix, MAX7219_REG_SHUTDOWN, 1) != MAX7219_SUCCESS ||           // Turn on display
+        max7219_flush(matrix) < 0)
+    {
+        fprintf(stderr, "Failed to send init command to MAX7219\n");
+        return MAX7219_ERROR_OPERATION_FAILED;
+    }
+
+    return MAX7219_SUCCESS;
+}
+
+void max7219_fb_clear(max7219_t *matrix)
+{
+    memset(matrix->rows, 0, sizeof(matrix->rows));
+}
+
+void max7219_fb_set_row(max7219_t *matrix, unsigned module, unsigned row, uint8_t bits)
+{
+    if (module < matrix->count && row < MAX7219_ROWS)
+    {
+        matrix->rows[row][module] = bits;
+    }
+}
+
+void max7219_fb_set_pixel(max7219_t *matrix, unsigned x, unsigned y, bool on)
+{
+    if (x >= MAX7219_COLS * matrix->count || y >= MAX7219_ROWS)
+    {
+        return;
+    }
+
+    uint8_t *bits = &matrix->rows[y][x / MAX7219_COLS];
+    if (on)
+    {
+        *bits |= 0x80 >> (x % MAX7219_COLS);
+    }
+    else
+    {
+        *bits &= ~(0x80 >> (x % MAX7219_COLS));
+    }
+}
+
+bool max7219_fb_get_pixel(const max7219_t *matrix, unsigned x, unsigned y)
+{
+    if (x >= MAX7219_COLS * matrix->count || y >= MAX7219_ROWS)
+    {
+        return false;
+    }
+
+    return (matrix->rows[y][x / MAX7219_COLS] & (0x80 >> (x % MAX7219_COLS))) != 0;
+}
+
+int max7219_flush_wait(max7219_t *matrix)
+{
+    if (!matrix->in_flight)
+    {
+        return MAX7219_SUCCESS;
+    }
+
+    matrix->in_flight = false;
+
+    if (rpi_spi_wait(&matrix->request) != SPI_SUCCESS)
+    {
+        // Part of the list may have been written; resend everything next time
+        matrix->valid = false;
+        return MAX7219_ERROR_OPERATION_FAILED;
+    }
+
+    memcpy(matrix->shown, matrix->sending, sizeof(matrix->shown));
+    matrix->valid = true;
+
+    return MAX7219_SUCCESS;
+}
+
+int max7219_flush_async(max7219_t *matrix)
+{
+    // The command buffers are reused, and the rows to send depend on what the last flush left shown
+    if (max7219_flush_wait(matrix) != MAX7219_SUCCESS)
+    {
+        return MAX7219_ERROR_OPERATION_FAILED;
+    }
+
+    unsigned count = 0;
+
+    for (unsigned row = 0; row < MAX7219_ROWS; row++)
+    {
+        bool dirty = false;
+
+        // The first pair shifted out ends up in the last device of the chain, module 0
+        for (unsigned module = 0; module < matrix->count; module++)
+        {
+            uint8_t *pair = &matrix->commands[count][2 * module];
+
+            if (matrix->valid && matrix->rows[row][module] == matrix->shown[row][module])
+            {
+                pair[0] = MAX7219_REG_NOOP;
+                pair[1] = 0x00;
+            }
+            else
+            {
+                pair[0] = MAX7219_REG_DIGIT0 + row;
+                pair[1] = matrix->rows[row][module];
+                dirty = true;
+            }
+        }
+
+        if (dirty)
+        {
+            matrix->segments[count] = (rpi_spi_segment_t){
+                .tx = matrix->commands[count],
+                .rx = NULL,
+                .len = 2 * matrix->count,
+                .flags = SPI_SEGMENT_CS_DEASSERT};
+            count++;
+        }
+    }
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    memcpy(matrix->sending, matrix->rows, sizeof(matrix->sending));
+
+    matrix->request = (rpi_spi_request_t){
+        .device_number = matrix->device,
+        .segments = matrix->segments,
+        .segment_count = count};
+
+    if (rpi_spi_submit(matrix->bus, &matrix->request) != SPI_SUCCESS)
+    {
+        matrix->valid = false;
+        return MAX7219_ERROR_OPERATION_FAILED;
+    }
+    matrix->in_flight = true;
+
+    return count;
+}
+
+int max7219_flush(max7219_t *matrix)
+{
+    int count = max7219_flush_async(matrix);
+    if (count <= 0)
+    {
+        return count;
+    }
+
+    return max7219_flush_wait(matrix) == MAX7219_SUCCESS ? count : MAX7219_ERROR_OPERATION_FAILED;
+}
+
+void max7219_invalidate(max7219_t *matrix)
+{
+    max7219_flush_wait(matrix);
+    matrix->valid = false;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAX7219_H
+#define MAX7219_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rpi_spi.h"
+
+/* Return codes for client API */
+#define MAX7219_SUCCESS 0
+#define MAX7219_ERROR_BAD_ARGUMENT -1
+#define MAX7219_ERROR_OPERATION_FAILED -2
+
+// MAX7219 command registers
+#define MAX7219_REG_NOOP        0x00
+#define MAX7219_REG_DIGIT0      0x01 // Base register for digit (row) control
+#define MAX7219_REG_DECODEMODE  0x09 // BCD decode mode
+#define MAX7219_REG_INTENSITY   0x0A // Intensity control
+#define MAX7219_REG_SCANLIMIT   0x0B // Number of digits to scan (0-7)
+#define MAX7219_REG_SHUTDOWN    0x0C // Shutdown control
+#define MAX7219_REG_DISPLAYTEST 0x0F // Display test mode
+
+#define MAX7219_ROWS 8
+#define MAX7219_COLS 8                   // columns per module
+#define MAX7219_MAX_DEVICES 8            // modules cascaded on one chip select
+
+/*
+ * A row of 8x8 LED matrices driven by MAX7219s cascaded on one chip select
+ * (DOUT of each device to DIN of the next), with a framebuffer. Drawing only
+ * changes memory; max7219_flush() sends the rows that differ from what the
+ * devices are showing. max7219_flush_async() does the same in the background,
+ * so the next frame can be drawn while the previous one is being sent.
+ *
+ * Module 0 is the leftmost one, i.e. the last in the chain (on common 4-in-1
+ * boards DIN enters on the right). In a row byte, bit 7 is the leftmost column.
+ */
+typedef struct
+{
+    unsigned bus;                                            // SPI bus number
+    unsigned device;                                         // SPI device (chip select) number
+    unsigned count;                                          // number of cascaded modules
+    uint8_t rows[MAX7219_ROWS][MAX7219_MAX_DEVICES];         // framebuffer being drawn
+    uint8_t shown[MAX7219_ROWS][MAX7219_MAX_DEVICES];        // rows last sent to the devices
+    bool valid;                                              // false until shown[] is known to match the devices
+
+    // Flush in progress: the commands being sent and the framebuffer they were built from
+    bool in_flight;
+    uint8_t sending[MAX7219_ROWS][MAX7219_MAX_DEVICES];
+    uint8_t commands[MAX7219_ROWS][2 * MAX7219_MAX_DEVICES];
+    rpi_spi_segment_t segments[MAX7219_ROWS];
+    rpi_spi_request_t request;
+} max7219_t;
+
+/**
+ * Configure the SPI device, initialize every MAX7219 in the chain for raw LED
+ * control and clear them
+ *
+ * @param    matrix      matrix state (output)
+ * @param    bus         SPI bus number
+ * @param    device      SPI device number
+ * @param    count       number of cascaded modules, 1 to MAX7219_MAX_DEVICES
+ * @param    speed_hz    SPI clock (the MAX7219 supports up to 10 MHz)
+ * @param    intensity   brightness, 0x00 to 0x0F
+ *
+ * @returns  MAX7219_SUCCESS                 on success,
+ *           MAX7219_ERROR_BAD_ARGUMENT      invalid pointer, module count or intensity
+ *           MAX7219_ERROR_OPERATION_FAILED  SPI operation failed
+ */
+int max7219_init(max7219_t *matrix, unsigned bus, unsigned device, unsigned count, uint32_t speed_hz, uint8_t intensity);
+
+/**
+ * Write the same control register of every module immediately, bypassing the
+ * framebuffer
+ *
+ * @param    matrix      matrix state
+ * @param    reg         MAX7219_REG_* register
+ * @param    value       register value
+ *
+ * @returns  MAX7219_SUCCESS                 on success,
+ *           MAX7219_ERROR_OPERATION_FAILED  SPI operation failed
+ */
+int max7219_send(max7219_t *matrix, uint8_t reg, uint8_t value);
+
+/**
+ * Clear the framebuffer
+ *
+ * @param    matrix      matrix state
+ */
+void max7219_fb_clear(max7219_t *matrix);
+
+/**
+ * Set one module's part of a framebuffer row
+ *
+ * @param    matrix      matrix state
+ * @param    module      module, 0 (left) to count - 1
+ * @param    row         row, 0 (top) to 7
+ * @param    bits        LED states, bit 7 is the module's leftmost column
+ */
+void max7219_fb_set_row(max7219_t *matrix, unsigned module, unsigned row, uint8_t bits);
+
+/**
+ * Turn a framebuffer pixel on or off; pixels outside the matrix are ignored
+ *
+ * @param    matrix      matrix state
+ * @param    x           column, 0 (left) to 8 * count - 1
+ * @param    y           row, 0 (top) to 7
+ * @param    on          LED state
+ */
+void max7219_fb_set_pixel(max7219_t *matrix, unsigned x, unsigned y, bool on);
+
+/**
+ * Read a framebuffer pixel
+ *
+ * @param    matrix      matrix state
+ * @param    x           column, 0 (left) to 8 * count - 1
+ * @param    y           row, 0 (top) to 7
+ *
+ * @returns  true if the pixel is on, false if it is off or outside the matrix
+ */
+bool max7219_fb_get_pixel(const max7219_t *matrix, unsigned x, unsigned y);
+
+/**
+ * Send the rows that changed since the last flush, as one transfer list with
+ * a CS pulse per row (the MAX7219 latches each register write on CS rising).
+ * A row is one 2 * count byte transfer that updates it on all modules at
+ * once; modules whose part of the row did not change receive a no-op.
+ *
+ * @param    matrix      matrix state
+ *
+ * @returns  the number of row transfers (0 if nothing changed) on success,
+ *           MAX7219_ERROR_OPERATION_FAILED  SPI operation failed
+ */
+int max7219_flush(max7219_t *matrix);
+
+/**
+ * Start sending the rows that changed since the last flush and return at once;
+ * the framebuffer can be drawn on while they are sent. A flush still in
+ * progress is waited for first.
+ *
+ * @param    matrix      matrix state
+ *
+ * @returns  the number of row transfers started (0 if nothing changed) on success,
+ *           MAX7219_ERROR_OPERATION_FAILED  SPI operation failed (this or the previous flush)
+ */
+int max7219_flush_async(max7219_t *matrix);
+
+/**
+ * Wait for the flush started by max7219_flush_async() to complete
+ *
+ * @param    matrix      matrix state
+ *
+ * @returns  MAX7219_SUCCESS                 on success or if no flush was in progress,
+ *           MAX7219_ERROR_OPERATION_FAILED  SPI operation failed
+ */
+int max7219_flush_wait(max7219_t *matrix);
+
+/**
+ * Forget what the device is showing, so the next flush rewrites every row
+ * (e.g. after the display was reset or its registers written directly).
+ * A flush in progress is waited for first.
+ *
+ * @param    matrix      matrix state
+ */
+void max7219_invalidate(max7219_t *matrix);
+
+#endif
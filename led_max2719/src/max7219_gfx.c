@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include "max7219_gfx.h"
+
+/*
+ * 5x7 font for ' ' to '~', stored column by column (bit 0 is the top row) so
+ * that a glyph takes five bytes and a column can be shifted in as is.
+ */
+static const uint8_t gfx_font[GFX_FONT_LAST - GFX_FONT_FIRST + 1][GFX_FONT_WIDTH] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, // '!'
+    {0x00, 0x07, 0x00, 0x07, 0x00}, // '"'
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // '#'
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // '$'
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // '%'
+    {0x36, 0x49, 0x55, 0x22, 0x50}, // '&'
+    {0x00, 0x05, 0x03, 0x00, 0x00}, // '''
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, // '('
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, // ')'
+    {0x08, 0x2A, 0x1C, 0x2A, 0x08}, // '*'
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, // '+'
+    {0x00, 0x50, 0x30, 0x00, 0x00}, // ','
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // '-'
+    {0x00, 0x60, 0x60, 0x00, 0x00}, // '.'
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // '/'
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // '0'
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // '1'
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // '2'
+    {0x21, 0x41, 0x45, 0x4B, 0x31}, // '3'
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // '4'
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // '5'
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // '6'
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // '7'
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // '8'
+    {0x06, 0x49, 0x49, 0x29, 0x1E}, // '9'
+    {0x00, 0x36, 0x36, 0x00, 0x00}, // ':'
+    {0x00, 0x56, 0x36, 0x00, 0x00}, // ';'
+    {0x08, 0x14, 0x22, 0x41, 0x00}, // '<'
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // '='
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // '>'
+    {0x02, 0x01, 0x51, 0x09, 0x06}, // '?'
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, // '@'
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // 'A'
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // 'B'
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // 'C'
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // 'D'
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // 'E'
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, // 'F'
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, // 'G'
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // 'H'
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // 'I'
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, // 'J'
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, // 'K'
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, // 'L'
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // 'M'
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // 'N'
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // 'O'
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // 'P'
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // 'Q'
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // 'R'
+    {0x46, 0x49, 0x49, 0x49, 0x31}, // 'S'
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, // 'T'
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // 'U'
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // 'V'
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // 'W'
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // 'X'
+    {0x07, 0x08, 0x70, 0x08, 0x07}, // 'Y'
+    {0x61, 0x51, 0x49, 0x45, 0x43}, // 'Z'
+    {0x00, 0x7F, 0x41, 0x41, 0x00}, // '['
+    {0x02, 0x04, 0x08, 0x10, 0x20}, // '\'
+    {0x00, 0x41, 0x41, 0x7F, 0x00}, // ']'
+    {0x04, 0x02, 0x01, 0x02, 0x04}, // '^'
+    {0x40, 0x40, 0x40, 0x40, 0x40}, // '_'
+    {0x00, 0x01, 0x02, 0x04, 0x00}, // '`'
+    {0x20, 0x54, 0x54, 0x54, 0x78}, // 'a'
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, // 'b'
+    {0x38, 0x44, 0x44, 0x44, 0x20}, // 'c'
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, // 'd'
+    {0x38, 0x54, 0x54, 0x54, 0x18}, // 'e'
+    {0x08, 0x7E, 0x09, 0x01, 0x02}, // 'f'
+    {0x0C, 0x52, 0x52, 0x52, 0x3E}, // 'g'
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, // 'h'
+    {0x00, 0x44, 0x7D, 0x40, 0x00}, // 'i'
+    {0x20, 0x40, 0x44, 0x3D, 0x00}, // 'j'
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, // 'k'
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, // 'l'
+    {0x7C, 0x04, 0x18, 0x04, 0x78}, // 'm'
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, // 'n'
+    {0x38, 0x44, 0x44, 0x44, 0x38}, // 'o'
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, // 'p'
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, // 'q'
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, // 'r'
+    {0x48, 0x54, 0x54, 0x54, 0x20}, // 's'
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, // 't'
+    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // 'u'
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // 'v'
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // 'w'
+    {0x44, 0x28, 0x10, 0x28, 0x44}, // 'x'
+    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // 'y'
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, // 'z'
+    {0x00, 0x08, 0x36, 0x41, 0x00}, // '{'
+    {0x00, 0x00, 0x7F, 0x00, 0x00}, // '|'
+    {0x00, 0x41, 0x36, 0x08, 0x00}, // '}'
+    {0x08, 0x04, 0x08, 0x10, 0x08}, // '~'
+};
+
+const uint8_t *gfx_font_glyph(char c)
+{
+    if (c < GFX_FONT_FIRST || c > GFX_FONT_LAST)
+    {
+        c = '?';
+    }
+
+    return gfx_font[c - GFX_FONT_FIRST];
+}
+
+/* Round a column down to its module, also for columns left of the display */
+static int module_of(int x)
+{
+    return x >= 0 ? x / MAX7219_COLS : -((MAX7219_COLS - 1 - x) / MAX7219_COLS);
+}
+
+static void apply_op(uint8_t *dst, uint8_t bits, uint8_t mask, gfx_op_t op)
+{
+    switch (op)
+    {
+    case GFX_OP_SET:
+        *dst |= bits;
+        break;
+    case GFX_OP_CLEAR:
+        *dst &= ~bits;
+        break;
+    case GFX_OP_XOR:
+        *dst ^= bits;
+        break;
+    case GFX_OP_COPY:
+        *dst = (*dst & ~mask) | bits;
+        break;
+    }
+}
+
+/* Combine 8 pixels starting at column x with a framebuffer row: at most two module bytes, split by a shift */
+static void blit_byte(max7219_t *matrix, unsigned row, int x, uint8_t bits, uint8_t mask, gfx_op_t op)
+{
+    int module = module_of(x);
+    unsigned shift = x - module * MAX7219_COLS;
+
+    if (module >= 0 && module < (int)matrix->count)
+    {
+        apply_op(&matrix->rows[row][module], bits >> shift, mask >> shift, op);
+    }
+
+    if (shift != 0 && module + 1 >= 0 && module + 1 < (int)matrix->count)
+    {
+        apply_op(&matrix->rows[row][module + 1], (uint8_t)(bits << (8 - shift)), (uint8_t)(mask << (8 - shift)), op);
+    }
+}
+
+void gfx_blit(max7219_t *matrix, const gfx_sprite_t *sprite, int x, int y, gfx_op_t op)
+{
+    unsigned bytes_per_row = (sprite->width + 7) / 8;
+
+    for (unsigned sy = 0; sy < sprite->height; sy++)
+    {
+        int row = y + (int)sy;
+        if (row < 0 || row >= MAX7219_ROWS)
+        {
+            continue;
+        }
+
+        for (unsigned i = 0; i < bytes_per_row; i++)
+        {
+            // The last byte of a row may only be partly covered by the sprite
+            unsigned pixels = sprite->width - 8 * i;
+            uint8_t mask = pixels >= 8 ? 0xFF : (uint8_t)(0xFF << (8 - pixels));
+            uint8_t bits = sprite->bits[sy * bytes_per_row + i] & mask;
+
+            blit_byte(matrix, row, x + 8 * (int)i, bits, mask, op);
+        }
+    }
+}
+
+int gfx_draw_char(max7219_t *matrix, int x, int y, char c)
+{
+    const uint8_t *glyph = gfx_font_glyph(c);
+    uint8_t rows[GFX_FONT_HEIGHT] = {0};
+
+    // Turn the glyph's columns into row bitmasks; the spacing column stays blank
+    for (unsigned col = 0; col < GFX_FONT_WIDTH; col++)
+    {
+        for (unsigned row = 0; row < GFX_FONT_HEIGHT; row++)
+        {
+            if (glyph[col] & (1 << row))
+            {
+                rows[row] |= 0x80 >> col;
+            }
+        }
+    }
+
+    gfx_sprite_t sprite = {.width = GFX_FONT_ADVANCE, .height = GFX_FONT_HEIGHT, .bits = rows};
+    gfx_blit(matrix, &sprite, x, y, GFX_OP_COPY);
+
+    return x + GFX_FONT_ADVANCE;
+}
+
+int gfx_draw_text(max7219_t *matrix, int x, int y, const char *text)
+{
+    for (; *text != '\0'; text++)
+    {
+        x = gfx_draw_char(matrix, x, y, *text);
+    }
+
+    return x;
+}
+
+void gfx_shift_left(max7219_t *matrix, uint8_t column)
+{
+    for (unsigned row = 0; row < MAX7219_ROWS; row++)
+    {
+        uint8_t *bytes = matrix->rows[row];
+
+        for (unsigned module = 0; module + 1 < matrix->count; module++)
+        {
+            bytes[module] = (uint8_t)(bytes[module] << 1) | (bytes[module + 1] >> 7);
+        }
+        bytes[matrix->count - 1] = (uint8_t)(bytes[matrix->count - 1] << 1) | ((column >> row) & 1);
+    }
+}
+
+void gfx_shift_right(max7219_t *matrix, uint8_t column)
+{
+    for (unsigned row = 0; row < MAX7219_ROWS; row++)
+    {
+        uint8_t *bytes = matrix->rows[row];
+
+        for (unsigned module = matrix->count - 1; module > 0; module--)
+        {
+            bytes[module] = (bytes[module] >> 1) | (uint8_t)(bytes[module - 1] << 7);
+        }
+        bytes[0] = (bytes[0] >> 1) | (uint8_t)(((column >> row) & 1) << 7);
+    }
+}
+
+void gfx_scroll_init(gfx_scroll_t *scroll, const char *text)
+{
+    memset(scroll, 0, sizeof(*scroll));
+    scroll->text = text;
+}
+
+bool gfx_scroll_step(max7219_t *matrix, gfx_scroll_t *scroll)
+{
+    uint8_t column = 0;
+    bool done = false;
+
+    if (scroll->text[scroll->index] != '\0')
+    {
+        if (scroll->column < GFX_FONT_WIDTH)
+        {
+            column = gfx_font_glyph(scroll->text[scroll->index])[scroll->column];
+        }
+
+        if (++scroll->column == GFX_FONT_ADVANCE)
+        {
+            scroll->column = 0;
+            scroll->index++;
+        }
+    }
+    else if (++scroll->trailing >= MAX7219_COLS * matrix->count - 1)
+    {
+        // The last column of the text has left the display, start over
+        scroll->index = 0;
+        scroll->column = 0;
+        scroll->trailing = 0;
+        done = true;
+    }
+
+    gfx_shift_left(matrix, column);
+
+    return done;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAX7219_GFX_H
+#define MAX7219_GFX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "max7219.h"
+
+// Built-in font: 5x7 pixel glyphs for printable ASCII, one blank column between characters
+#define GFX_FONT_WIDTH   5
+#define GFX_FONT_HEIGHT  7
+#define GFX_FONT_FIRST   ' '
+#define GFX_FONT_LAST    '~'
+#define GFX_FONT_ADVANCE (GFX_FONT_WIDTH + 1)
+
+/* How a sprite's pixels are combined with the framebuffer */
+typedef enum
+{
+    GFX_OP_SET,      // light the sprite's pixels
+    GFX_OP_CLEAR,    // turn off the sprite's pixels
+    GFX_OP_XOR,      // toggle the sprite's pixels
+    GFX_OP_COPY      // replace the area covered by the sprite
+} gfx_op_t;
+
+/*
+ * A monochrome sprite stored as row bitmasks, like the framebuffer: each row
+ * takes (width + 7) / 8 bytes and bit 7 of the first byte is the leftmost pixel.
+ */
+typedef struct
+{
+    uint8_t width;
+    uint8_t height;
+    const uint8_t *bits;
+} gfx_sprite_t;
+
+/* State of a text scrolling right to left across the display */
+typedef struct
+{
+    const char *text;
+    size_t index;        // character being shifted in
+    unsigned column;     // next column of that character, GFX_FONT_ADVANCE columns per character
+    unsigned trailing;   // blank columns shifted in after the text, to clear the display
+} gfx_scroll_t;
+
+/**
+ * Look up a glyph of the built-in font
+ *
+ * @param    c       character
+ *
+ * @returns  GFX_FONT_WIDTH column bytes (bit 0 is the top row), or the glyph
+ *           of '?' for characters the font does not have
+ */
+const uint8_t *gfx_font_glyph(char c);
+
+/**
+ * Draw a sprite into the framebuffer; the parts outside the display are clipped
+ *
+ * @param    matrix  matrix state
+ * @param    sprite  sprite to draw
+ * @param    x       column of the sprite's left edge (may be negative)
+ * @param    y       row of the sprite's top edge (may be negative)
+ * @param    op      how the sprite is combined with the framebuffer
+ */
+void gfx_blit(max7219_t *matrix, const gfx_sprite_t *sprite, int x, int y, gfx_op_t op);
+
+/**
+ * Draw a character of the built-in font, replacing the pixels under it
+ *
+ * @param    matrix  matrix state
+ * @param    x       column of the character's left edge (may be negative)
+ * @param    y       row of the character's top edge
+ * @param    c       character
+ *
+ * @returns  the column following the character and its spacing
+ */
+int gfx_draw_char(max7219_t *matrix, int x, int y, char c);
+
+/**
+ * Draw a string of the built-in font
+ *
+ * @param    matrix  matrix state
+ * @param    x       column of the first character's left edge (may be negative)
+ * @param    y       row of the characters' top edge
+ * @param    text    string to draw
+ *
+ * @returns  the column following the last character
+ */
+int gfx_draw_text(max7219_t *matrix, int x, int y, const char *text);
+
+/**
+ * Shift the whole framebuffer one column to the left, carrying bits across
+ * module boundaries, and shift a new column in on the right
+ *
+ * @param    matrix  matrix state
+ * @param    column  pixels of the new column, bit n is row n
+ */
+void gfx_shift_left(max7219_t *matrix, uint8_t column);
+
+/**
+ * Shift the whole framebuffer one column to the right, and shift a new column
+ * in on the left
+ *
+ * @param    matrix  matrix state
+ * @param    column  pixels of the new column, bit n is row n
+ */
+void gfx_shift_right(max7219_t *matrix, uint8_t column);
+
+/**
+ * Prepare to scroll a text across the display
+ *
+ * @param    scroll  scroll state (output)
+ * @param    text    string to scroll, must remain valid while scrolling
+ */
+void gfx_scroll_init(gfx_scroll_t *scroll, const char *text);
+
+/**
+ * Advance the scrolling text by one column: one shift of the framebuffer,
+ * which the caller then flushes
+ *
+ * @param    matrix  matrix state
+ * @param    scroll  scroll state
+ *
+ * @returns  true once the whole text has scrolled off the display; the next
+ *           step starts it again from the right edge
+ */
+bool gfx_scroll_step(max7219_t *matrix, gfx_scroll_t *scroll);
+
+#endif
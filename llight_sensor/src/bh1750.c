@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include "rpi_i2c.h"
+#include "bh1750.h"
+
+// Instructions
+#define BH1750_POWER_DOWN   0x00
+#define BH1750_POWER_ON     0x01
+#define BH1750_RESET        0x07
+#define BH1750_MTREG_HIGH   0x40    // 01000_MT[7,6,5]
+#define BH1750_MTREG_LOW    0x60    // 011_MT[4,3,2,1,0]
+
+// Measurement instructions, indexed by [mode][resolution]
+static const uint8_t BH1750_MEASURE_CMD[2][3] = {
+    {0x13, 0x10, 0x11},     // continuous L, H, H2
+    {0x23, 0x20, 0x21},     // one-time L, H, H2
+};
+
+// Maximum measurement time at the default MTreg, indexed by resolution
+static const uint32_t BH1750_MEASURE_US[3] = {24000, 180000, 180000};
+
+// One-shot period on top of the measurement time, covering the trigger and fetch transactions
+#define BH1750_ONE_SHOT_MARGIN_US 2000
+
+// Auto-ranging keeps the raw count between these limits
+#define BH1750_RAW_HIGH 49152   // 75% of full scale
+#define BH1750_RAW_LOW  4096
+
+/* Send a single byte instruction */
+static int bh1750_command(bh1750_t *sensor, uint8_t cmd)
+{
+    if (smbus_write_byte(sensor->bus, sensor->address, cmd) != I2C_SUCCESS)
+    {
+        return BH1750_ERROR_OPERATION_FAILED;
+    }
+
+    return BH1750_SUCCESS;
+}
+
+int bh1750_init(bh1750_t *sensor)
+{
+    if (sensor == NULL || sensor->mode > BH1750_ONE_SHOT || sensor->resolution > BH1750_RES_HIGH2)
+    {
+        return BH1750_ERROR_BAD_ARGUMENT;
+    }
+
+    if (sensor->mtreg == 0)
+    {
+        sensor->mtreg = BH1750_MTREG_DEFAULT;
+    }
+
+    // Reset only clears the data register, and only while powered on
+    if (bh1750_command(sensor, BH1750_POWER_ON) != BH1750_SUCCESS ||
+        bh1750_command(sensor, BH1750_RESET) != BH1750_SUCCESS ||
+        bh1750_set_mtreg(sensor, sensor->mtreg) != BH1750_SUCCESS)
+    {
+        return BH1750_ERROR_OPERATION_FAILED;
+    }
+
+    sensor->discard_next = false;
+
+    if (sensor->mode == BH1750_CONTINUOUS)
+    {
+        return bh1750_start(sensor);
+    }
+
+    return BH1750_SUCCESS;
+}
+
+int bh1750_start(bh1750_t *sensor)
+{
+    if (sensor == NULL)
+    {
+        return BH1750_ERROR_BAD_ARGUMENT;
+    }
+
+    return bh1750_command(sensor, BH1750_MEASURE_CMD[sensor->mode][sensor->resolution]);
+}
+
+int bh1750_set_mtreg(bh1750_t *sensor, uint8_t mtreg)
+{
+    if (sensor == NULL)
+    {
+        return BH1750_ERROR_BAD_ARGUMENT;
+    }
+
+    if (mtreg < BH1750_MTREG_MIN)
+    {
+        mtreg = BH1750_MTREG_MIN;
+    }
+    if (mtreg > BH1750_MTREG_MAX)
+    {
+        mtreg = BH1750_MTREG_MAX;
+    }
+
+    if (bh1750_command(sensor, BH1750_MTREG_HIGH | (mtreg >> 5)) != BH1750_SUCCESS ||
+        bh1750_command(sensor, BH1750_MTREG_LOW | (mtreg & 0x1F)) != BH1750_SUCCESS)
+    {
+        return BH1750_ERROR_OPERATION_FAILED;
+    }
+
+    sensor->mtreg = mtreg;
+    return BH1750_SUCCESS;
+}
+
+int bh1750_read_raw(bh1750_t *sensor, uint16_t *raw)
+{
+    uint8_t buffer[2];
+
+    if (sensor == NULL || raw == NULL)
+    {
+        return BH1750_ERROR_BAD_ARGUMENT;
+    }
+
+    if (smbus_read_block(sensor->bus, sensor->address, buffer, sizeof(buffer)) != I2C_SUCCESS)
+    {
+        return BH1750_ERROR_OPERATION_FAILED;
+    }
+
+    *raw = (buffer[0] << 8) | buffer[1];
+    return BH1750_SUCCESS;
+}
+
+uint32_t bh1750_raw_to_millilux(const bh1750_t *sensor, uint16_t raw)
+{
+    // lx = raw / 1.2 * (69 / MTreg), halved in H2 mode
+    uint64_t millilux = (uint64_t)raw * 1000 * 10 * BH1750_MTREG_DEFAULT / (12 * (uint64_t)sensor->mtreg);
+
+    if (sensor->resolution == BH1750_RES_HIGH2)
+    {
+        millilux /= 2;
+    }
+
+    return (uint32_t)millilux;
+}
+
+uint32_t bh1750_measurement_time_us(const bh1750_t *sensor)
+{
+    return BH1750_MEASURE_US[sensor->resolution] * sensor->mtreg / BH1750_MTREG_DEFAULT;
+}
+
+int bh1750_power_down(bh1750_t *sensor)
+{
+    if (sensor == NULL)
+    {
+        return BH1750_ERROR_BAD_ARGUMENT;
+    }
+
+    return bh1750_command(sensor, BH1750_POWER_DOWN);
+}
+
+/* Pick a new mtreg if the raw count is close to saturation or to the noise floor, returns 0 if unchanged */
+static uint8_t bh1750_auto_range(const bh1750_t *sensor, uint16_t raw)
+{
+    unsigned mtreg = sensor->mtreg;
+
+    if (raw > BH1750_RAW_HIGH && mtreg > BH1750_MTREG_MIN)
+    {
+        mtreg /= 2;
+    }
+    else if (raw < BH1750_RAW_LOW && mtreg < BH1750_MTREG_MAX)
+    {
+        mtreg *= 2;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (mtreg < BH1750_MTREG_MIN)
+    {
+        mtreg = BH1750_MTREG_MIN;
+    }
+    if (mtreg > BH1750_MTREG_MAX)
+    {
+        mtreg = BH1750_MTREG_MAX;
+    }
+
+    return (uint8_t)mtreg;
+}
+
+/* Sampling period: continuous measurements follow each other, one-shot ones also need a trigger and a fetch */
+static uint32_t sched_period_us(const bh1750_t *sensor)
+{
+    uint32_t period_us = bh1750_measurement_time_us(sensor);
+
+    return sensor->mode == BH1750_ONE_SHOT ? period_us + BH1750_ONE_SHOT_MARGIN_US : period_us;
+}
+
+/* Keep the scheduler timing in step with the sensor's integration time */
+static void sched_update_timing(i2c_sched_device_t *dev)
+{
+    bh1750_t *sensor = dev->priv;
+
+    dev->conversion_us = bh1750_measurement_time_us(sensor);
+    dev->period_us = sched_period_us(sensor);
+}
+
+static int sched_setup(i2c_sched_device_t *dev)
+{
+    if (bh1750_init(dev->priv) != BH1750_SUCCESS)
+    {
+        fprintf(stderr, "BH1750: Failed to initialize sensor\n");
+        return -1;
+    }
+
+    sched_update_timing(dev);
+    return 0;
+}
+
+static int sched_trigger(i2c_sched_device_t *dev)
+{
+    return bh1750_start(dev->priv) == BH1750_SUCCESS ? 0 : -1;
+}
+
+static int sched_fetch(i2c_sched_device_t *dev, i2c_sched_sample_t *sample)
+{
+    bh1750_t *sensor = dev->priv;
+    uint16_t raw;
+
+    if (bh1750_read_raw(sensor, &raw) != BH1750_SUCCESS)
+    {
+        fprintf(stderr, "BH1750: Failed to read data\n");
+        return -1;
+    }
+
+    // The first continuous result after an mtreg change was integrated with the old setting
+    bool discard = sensor->discard_next;
+    sensor->discard_next = false;
+
+    sample->value[0] = (int32_t)bh1750_raw_to_millilux(sensor, raw);
+    sample->value[1] = raw;
+    sample->count = 2;
+
+    uint8_t mtreg = sensor->auto_range ? bh1750_auto_range(sensor, raw) : 0;
+    if (mtreg != 0 && bh1750_set_mtreg(sensor, mtreg) == BH1750_SUCCESS)
+    {
+        if (sensor->mode == BH1750_CONTINUOUS)
+        {
+            // Restart so the next measurement uses the new measurement time
+            bh1750_start(sensor);
+            sensor->discard_next = true;
+        }
+        sched_update_timing(dev);
+    }
+
+    return discard ? I2C_SCHED_SKIP : 0;
+}
+
+void bh1750_sched_device_init(bh1750_t *sensor, i2c_sched_device_t *dev, const char *name)
+{
+    if (sensor->mtreg == 0)
+    {
+        sensor->mtreg = BH1750_MTREG_DEFAULT;
+    }
+
+    *dev = (i2c_sched_device_t){
+        .name = name,
+        .bus = sensor->bus,
+        .address = sensor->address,
+        .period_us = sched_period_us(sensor),
+        .conversion_us = bh1750_measurement_time_us(sensor),
+        .setup = sched_setup,
+        .trigger = sensor->mode == BH1750_ONE_SHOT ? sched_trigger : NULL,
+        .fetch = sched_fetch,
+        .priv = sensor};
+}
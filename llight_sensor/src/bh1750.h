@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BH1750_H
+#define BH1750_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "i2c_sched.h"
+
+/* Return codes for client API */
+#define BH1750_SUCCESS 0
+#define BH1750_ERROR_BAD_ARGUMENT -1
+#define BH1750_ERROR_OPERATION_FAILED -2
+
+/* Measurement time register limits */
+#define BH1750_MTREG_MIN     31
+#define BH1750_MTREG_DEFAULT 69
+#define BH1750_MTREG_MAX     254
+
+/* Measurement mode */
+typedef enum
+{
+    BH1750_CONTINUOUS,   // measures continuously, results are read as they complete
+    BH1750_ONE_SHOT      // measures once per trigger, then powers down
+} bh1750_mode_t;
+
+/* Measurement resolution */
+typedef enum
+{
+    BH1750_RES_LOW,      // 4 lx resolution, 24 ms at the default MTreg
+    BH1750_RES_HIGH,     // 1 lx resolution, 180 ms at the default MTreg
+    BH1750_RES_HIGH2     // 0.5 lx resolution, 180 ms at the default MTreg
+} bh1750_resolution_t;
+
+/* A BH1750 ambient light sensor */
+typedef struct
+{
+    unsigned bus;                      // I2C bus number
+    uint8_t address;                   // I2C address (0x23 or 0x5C)
+    bh1750_mode_t mode;                // measurement mode
+    bh1750_resolution_t resolution;    // measurement resolution
+    uint8_t mtreg;                     // measurement time register (BH1750_MTREG_MIN to BH1750_MTREG_MAX)
+    bool auto_range;                   // adjust mtreg to keep readings away from saturation and the noise floor
+    bool discard_next;                 // set when the current continuous measurement predates an mtreg change
+} bh1750_t;
+
+/**
+ * Power on and reset the sensor, program the measurement time and, in
+ * continuous mode, start measuring
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  BH1750_SUCCESS                 on success,
+ *           BH1750_ERROR_BAD_ARGUMENT      invalid sensor pointer or configuration
+ *           BH1750_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int bh1750_init(bh1750_t *sensor);
+
+/**
+ * Start a measurement (one-shot mode) or restart continuous measurement
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  BH1750_SUCCESS                 on success,
+ *           BH1750_ERROR_BAD_ARGUMENT      invalid sensor pointer
+ *           BH1750_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int bh1750_start(bh1750_t *sensor);
+
+/**
+ * Change the measurement time register. Takes effect with the next measurement.
+ *
+ * @param    sensor  sensor description
+ * @param    mtreg   new value, clamped to BH1750_MTREG_MIN..BH1750_MTREG_MAX
+ *
+ * @returns  BH1750_SUCCESS                 on success,
+ *           BH1750_ERROR_BAD_ARGUMENT      invalid sensor pointer
+ *           BH1750_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int bh1750_set_mtreg(bh1750_t *sensor, uint8_t mtreg);
+
+/**
+ * Read the raw 16-bit result of the last measurement
+ *
+ * @param    sensor  sensor description
+ * @param    raw     raw count (output)
+ *
+ * @returns  BH1750_SUCCESS                 on success,
+ *           BH1750_ERROR_BAD_ARGUMENT      invalid pointer
+ *           BH1750_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int bh1750_read_raw(bh1750_t *sensor, uint16_t *raw);
+
+/**
+ * Convert a raw count to illuminance using integer arithmetic
+ *
+ * @param    sensor  sensor description (resolution and mtreg used for the measurement)
+ * @param    raw     raw count
+ *
+ * @returns  the illuminance in milli lux
+ */
+uint32_t bh1750_raw_to_millilux(const bh1750_t *sensor, uint16_t raw);
+
+/**
+ * Maximum time a measurement takes at the current resolution and mtreg
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  the measurement time in microseconds
+ */
+uint32_t bh1750_measurement_time_us(const bh1750_t *sensor);
+
+/**
+ * Put the sensor into power down mode
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  BH1750_SUCCESS                 on success,
+ *           BH1750_ERROR_BAD_ARGUMENT      invalid sensor pointer
+ *           BH1750_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int bh1750_power_down(bh1750_t *sensor);
+
+/**
+ * Describe the sensor to the I2C sampling scheduler. The sampling period
+ * follows the measurement time (plus 2ms in one-shot mode, for the trigger
+ * and fetch), and each result is read as soon as it is complete; with
+ * auto_range set the period shortens in bright light. Samples carry
+ * the illuminance in milli lux (value[0]) and the raw count (value[1]).
+ *
+ * @param    sensor  sensor description, must outlive the scheduler
+ * @param    dev     scheduler device (output)
+ * @param    name    device name used in samples
+ */
+void bh1750_sched_device_init(bh1750_t *sensor, i2c_sched_device_t *dev, const char *name);
+
+#endif
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "i2c_sched.h"
+
+#define MAX_I2C_BUSES 10 // same limit as rpi_i2c.c
+
+/* Scheduling state of a registered device */
+typedef struct
+{
+    i2c_sched_device_t *dev;
+    bool converting;         // trigger() issued, waiting for the result
+    uint64_t next_ns;        // time of the next trigger() or fetch()
+    uint64_t due_ns;         // time the pending operation was scheduled for, before any retry
+} sched_entry_t;
+
+/* State of one bus thread */
+typedef struct
+{
+    bool in_use;
+    bool started;            // the thread was created and has not been joined yet
+    pthread_t thread;
+    unsigned entry_count;
+    sched_entry_t entries[I2C_SCHED_MAX_DEVICES];
+    i2c_sched_stats_t stats;
+    uint64_t start_ns;
+} sched_bus_t;
+
+static sched_bus_t sched_buses[MAX_I2C_BUSES];
+static unsigned sched_device_count;
+
+static i2c_sched_callback_t sched_callback;
+static void *sched_callback_arg;
+
+// Protects the running flag and the statistics, and wakes the bus threads on stop
+static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sched_cond;
+static pthread_once_t sched_cond_once = PTHREAD_ONCE_INIT;
+static bool sched_running;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Timed waits are measured against the same clock as the schedule */
+static void init_cond(void)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sched_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/* Sleep until the given CLOCK_MONOTONIC time, returns false if the scheduler was stopped */
+static bool wait_until(uint64_t deadline_ns)
+{
+    struct timespec ts = {
+        .tv_sec = deadline_ns / 1000000000ULL,
+        .tv_nsec = deadline_ns % 1000000000ULL};
+
+    pthread_mutex_lock(&sched_mutex);
+    while (sched_running)
+    {
+        if (pthread_cond_timedwait(&sched_cond, &sched_mutex, &ts) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    bool running = sched_running;
+    pthread_mutex_unlock(&sched_mutex);
+
+    return running;
+}
+
+/* Pick the entry with the earliest pending operation; fetches win ties so results are not left waiting */
+static sched_entry_t *next_entry(sched_bus_t *bus)
+{
+    sched_entry_t *next = NULL;
+
+    for (unsigned i = 0; i < bus->entry_count; i++)
+    {
+        sched_entry_t *entry = &bus->entries[i];
+        if (next == NULL || entry->next_ns < next->next_ns ||
+            (entry->next_ns == next->next_ns && entry->converting && !next->converting))
+        {
+            next = entry;
+        }
+    }
+
+    return next;
+}
+
+/* Account for a bus transaction that started at start_ns */
+static void add_stats(sched_bus_t *bus, uint64_t start_ns, bool ok, bool published)
+{
+    uint64_t end_ns = now_ns();
+
+    pthread_mutex_lock(&sched_mutex);
+    bus->stats.busy_ns += end_ns - start_ns;
+    if (!ok)
+    {
+        bus->stats.errors++;
+    }
+    else if (published)
+    {
+        bus->stats.samples++;
+    }
+    pthread_mutex_unlock(&sched_mutex);
+}
+
+/*
+ * Advance to the next period. A period that is already due runs at once;
+ * only periods whose whole slot has passed are skipped and counted.
+ */
+static void schedule_next_period(sched_bus_t *bus, sched_entry_t *entry, uint64_t trigger_ns, uint64_t now)
+{
+    uint64_t period_ns = (uint64_t)entry->dev->period_us * 1000ULL;
+    uint64_t next = trigger_ns + period_ns;
+
+    if (next + period_ns <= now)
+    {
+        uint64_t missed = (now - next) / period_ns;
+        next += missed * period_ns;
+
+        pthread_mutex_lock(&sched_mutex);
+        bus->stats.overruns += missed;
+        pthread_mutex_unlock(&sched_mutex);
+    }
+
+    entry->converting = false;
+    entry->next_ns = next;
+    entry->due_ns = next;
+}
+
+/*
+ * Bus thread: runs the pending operation with the earliest deadline. A device
+ * waiting for its conversion does not hold the bus, so the triggers and
+ * fetches of all devices on the bus interleave.
+ */
+static void *bus_thread(void *arg)
+{
+    sched_bus_t *bus = arg;
+
+    for (;;)
+    {
+        sched_entry_t *entry = next_entry(bus);
+        if (entry == NULL || !wait_until(entry->next_ns))
+        {
+            break;
+        }
+
+        i2c_sched_device_t *dev = entry->dev;
+        uint64_t start = now_ns();
+
+        if (!entry->converting && dev->trigger != NULL)
+        {
+            bool ok = dev->trigger(dev) == 0;
+            add_stats(bus, start, ok, false);
+
+            if (ok)
+            {
+                // The result is read once the conversion is done, but the period stays on the scheduled grid
+                entry->converting = true;
+                entry->next_ns = start + (uint64_t)dev->conversion_us * 1000ULL;
+                entry->due_ns += (uint64_t)dev->conversion_us * 1000ULL;
+            }
+            else
+            {
+                schedule_next_period(bus, entry, entry->due_ns, start);
+            }
+            continue;
+        }
+
+        // The trigger time of this period, used to keep the period free of drift
+        uint64_t trigger_ns = entry->due_ns;
+        if (entry->converting)
+        {
+            trigger_ns -= (uint64_t)dev->conversion_us * 1000ULL;
+        }
+
+        i2c_sched_sample_t sample = {.name = dev->name};
+        int status = dev->fetch(dev, &sample);
+        sample.timestamp_ns = now_ns();
+        add_stats(bus, start, status >= 0, status == 0);
+
+        // The result was late: the other devices use the bus until it is fetched again
+        if (status == I2C_SCHED_RETRY)
+        {
+            entry->next_ns = sample.timestamp_ns + (uint64_t)dev->retry_us * 1000ULL;
+            continue;
+        }
+
+        if (status == 0)
+        {
+            sched_callback(&sample, sched_callback_arg);
+        }
+
+        schedule_next_period(bus, entry, trigger_ns, sample.timestamp_ns);
+    }
+
+    return NULL;
+}
+
+int i2c_sched_add_device(i2c_sched_device_t *dev)
+{
+    if (dev == NULL || dev->fetch == NULL || dev->period_us == 0 || dev->bus >= MAX_I2C_BUSES)
+    {
+        return I2C_SCHED_ERROR_BAD_ARGUMENT;
+    }
+
+    if (sched_running)
+    {
+        return I2C_SCHED_ERROR_RUNNING;
+    }
+
+    if (sched_device_count >= I2C_SCHED_MAX_DEVICES)
+    {
+        return I2C_SCHED_ERROR_FULL;
+    }
+
+    sched_bus_t *bus = &sched_buses[dev->bus];
+    bus->entries[bus->entry_count++] = (sched_entry_t){.dev = dev};
+    bus->in_use = true;
+    sched_device_count++;
+
+    return I2C_SCHED_SUCCESS;
+}
+
+int i2c_sched_start(i2c_sched_callback_t callback, void *arg)
+{
+    if (callback == NULL)
+    {
+        return I2C_SCHED_ERROR_BAD_ARGUMENT;
+    }
+
+    if (sched_running)
+    {
+        return I2C_SCHED_ERROR_RUNNING;
+    }
+
+    sched_callback = callback;
+    sched_callback_arg = arg;
+    pthread_once(&sched_cond_once, init_cond);
+
+    for (unsigned b = 0; b < MAX_I2C_BUSES; b++)
+    {
+        sched_bus_t *bus = &sched_buses[b];
+
+        for (unsigned i = 0; i < bus->entry_count; i++)
+        {
+            i2c_sched_device_t *dev = bus->entries[i].dev;
+            if (dev->setup != NULL && dev->setup(dev) != 0)
+            {
+                fprintf(stderr, "i2c_sched: setup of %s failed\n", dev->name);
+                return I2C_SCHED_ERROR_SETUP_FAILED;
+            }
+        }
+    }
+
+    sched_running = true;
+
+    // The bus threads inherit a mask blocking SIGINT and SIGTERM, so these reach the application threads
+    sigset_t signals, old_signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+
+    int status = I2C_SCHED_SUCCESS;
+    uint64_t start = now_ns();
+    for (unsigned b = 0; b < MAX_I2C_BUSES; b++)
+    {
+        sched_bus_t *bus = &sched_buses[b];
+        if (!bus->in_use)
+        {
+            continue;
+        }
+
+        memset(&bus->stats, 0, sizeof(bus->stats));
+        bus->start_ns = start;
+
+        for (unsigned i = 0; i < bus->entry_count; i++)
+        {
+            sched_entry_t *entry = &bus->entries[i];
+            entry->converting = false;
+            entry->next_ns = start;
+
+            // Free-running devices have their first result ready one conversion after setup
+            if (entry->dev->trigger == NULL)
+            {
+                entry->next_ns += (uint64_t)entry->dev->conversion_us * 1000ULL;
+            }
+            entry->due_ns = entry->next_ns;
+        }
+
+        int err = pthread_create(&bus->thread, NULL, bus_thread, bus);
+        if (err != EOK)
+        {
+            errno = err;
+            perror("pthread_create");
+            status = I2C_SCHED_ERROR_THREAD;
+            break;
+        }
+        bus->started = true;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+
+    if (status != I2C_SCHED_SUCCESS)
+    {
+        i2c_sched_stop();
+    }
+
+    return status;
+}
+
+int i2c_sched_stop(void)
+{
+    pthread_once(&sched_cond_once, init_cond);
+
+    pthread_mutex_lock(&sched_mutex);
+    sched_running = false;
+    pthread_cond_broadcast(&sched_cond);
+    pthread_mutex_unlock(&sched_mutex);
+
+    for (unsigned b = 0; b < MAX_I2C_BUSES; b++)
+    {
+        sched_bus_t *bus = &sched_buses[b];
+        if (bus->started)
+        {
+            pthread_join(bus->thread, NULL);
+            bus->started = false;
+        }
+        bus->in_use = false;
+        bus->entry_count = 0;
+    }
+
+    sched_device_count = 0;
+
+    return I2C_SCHED_SUCCESS;
+}
+
+int i2c_sched_get_stats(unsigned bus_number, i2c_sched_stats_t *stats)
+{
+    if (bus_number >= MAX_I2C_BUSES || stats == NULL)
+    {
+        return I2C_SCHED_ERROR_BAD_ARGUMENT;
+    }
+
+    sched_bus_t *bus = &sched_buses[bus_number];
+
+    pthread_mutex_lock(&sched_mutex);
+    *stats = bus->stats;
+    stats->elapsed_ns = bus->in_use ? now_ns() - bus->start_ns : 0;
+    pthread_mutex_unlock(&sched_mutex);
+
+    return I2C_SCHED_SUCCESS;
+}
@@ -1,8 +1,10 @@
 #include <stdio.h>      // For printf
 #include <stdint.h>     // For uint8_t type
 #include <string.h>     // For memory operations (not used here but commonly included)
-#include <unistd.h>     // For usleep
+#include <unistd.h>     // For pause
 #include "rpi_i2c.h"    // Custom I2C API for Raspberry Pi or QNX
+#include "i2c_sched.h"  // Periodic sampling scheduler for I2C sensors
+#include "bh1750.h"     // BH1750 light sensor driver
 #include <stdbool.h>     // Needed for `bool`
 #include <signal.h>      // Needed for signal handling
 
@@ -13,23 +15,11 @@
 // Flag to control main loop execution
 bool running = true;
 
-// Reads 2 bytes of lux data from the sensor and returns the light level in lux
-int i2c_read_lux() {
-    uint8_t buffer[2];  // Buffer to store the two bytes from the sensor
-
-    // Read two bytes from the sensor over I2C
-    int response = smbus_read_block(BUS, I2C_ADDR, buffer, sizeof(buffer));
-    if (response != I2C_SUCCESS) {
-        printf("Failed to read bytes\n");
-        return -1;
-    }
-
-    // Combine the two bytes into a 16-bit value
-    int lux = (int)(buffer[0]) << 8;  // High byte
-    lux |= buffer[1];                 // Low byte
-
-    // Convert raw value to lux using a fixed conversion factor
-    return lux / 1.2;
+// Prints every sample published by the scheduler
+static void print_sample(const i2c_sched_sample_t *sample, void *arg) {
+    (void)(arg);
+    uint32_t millilux = (uint32_t)sample->value[0];
+    printf("lux: %u.%03u\n", millilux / 1000, millilux % 1000);  // Print lux value to console
 }
 
 // Signal handler to exit the main loop gracefully
@@ -52,27 +42,35 @@ int main() {
     // Set up signal handlers
     setup_handlers();
 
-    // Send command to sensor to set it to "continuous high resolution mode"
-    int response = smbus_write_byte(BUS, I2C_ADDR, 0x10);
-    if (response != I2C_SUCCESS) {
-        printf("Failed to write byte\n");
+    // One-shot high resolution measurements, read as soon as each integration completes.
+    // Auto-ranging shortens the integration time (and the sampling period) in bright light.
+    bh1750_t sensor = {
+        .bus = BUS,
+        .address = I2C_ADDR,
+        .mode = BH1750_ONE_SHOT,
+        .resolution = BH1750_RES_HIGH,
+        .mtreg = BH1750_MTREG_DEFAULT,
+        .auto_range = true,
+    };
+
+    i2c_sched_device_t bh1750;
+    bh1750_sched_device_init(&sensor, &bh1750, "bh1750");
+
+    if (i2c_sched_add_device(&bh1750) != I2C_SCHED_SUCCESS ||
+        i2c_sched_start(print_sample, NULL) != I2C_SCHED_SUCCESS) {
+        printf("Failed to start sampling\n");
+        smbus_cleanup(BUS);
         return -1;
     }
 
-    // Continuously read and print lux values
+    // Samples are printed from the scheduler thread until interrupted
     while (running) {
-        int lux = i2c_read_lux();  // Read light level from sensor
-
-        if (lux == -1) {
-            printf("Failed to read lux\n");
-            return -1;
-        } else {
-            printf("lux: %d\n", lux);  // Print lux value to console
-        }
-
-        usleep(200000); // Sleep for 200 milliseconds before next read
+        pause();
     }
 
+    i2c_sched_stop();
+    bh1750_power_down(&sensor);
+
     // Cleanup I2C resources
     smbus_cleanup(BUS);
     return 0;
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "rpi_gpio.h"
+#include "segment_display.h"
+
+#define SEGMENT_MAX_GPIO 31 // the masks cover the first bank of set and clear registers
+
+/* Glyphs of the printable ASCII characters, one byte of SEGMENT_* bits each; 0 is blank */
+static const uint8_t glyphs[128] = {
+    ['0'] = 0x3F, ['1'] = 0x06, ['2'] = 0x5B, ['3'] = 0x4F, ['4'] = 0x66,
+    ['5'] = 0x6D, ['6'] = 0x7D, ['7'] = 0x07, ['8'] = 0x7F, ['9'] = 0x6F,
+
+    ['A'] = 0x77, ['a'] = 0x77, ['B'] = 0x7C, ['b'] = 0x7C, ['C'] = 0x39, ['c'] = 0x58,
+    ['D'] = 0x5E, ['d'] = 0x5E, ['E'] = 0x79, ['e'] = 0x79, ['F'] = 0x71, ['f'] = 0x71,
+    ['G'] = 0x3D, ['g'] = 0x3D, ['H'] = 0x76, ['h'] = 0x74, ['I'] = 0x30, ['i'] = 0x30,
+    ['J'] = 0x1E, ['j'] = 0x1E, ['L'] = 0x38, ['l'] = 0x38, ['N'] = 0x54, ['n'] = 0x54,
+    ['O'] = 0x3F, ['o'] = 0x5C, ['P'] = 0x73, ['p'] = 0x73, ['Q'] = 0x67, ['q'] = 0x67,
+    ['R'] = 0x50, ['r'] = 0x50, ['S'] = 0x6D, ['s'] = 0x6D, ['T'] = 0x78, ['t'] = 0x78,
+    ['U'] = 0x3E, ['u'] = 0x1C, ['Y'] = 0x6E, ['y'] = 0x6E,
+
+    [' '] = 0x00, ['-'] = 0x40, ['_'] = 0x08, ['='] = 0x48, ['.'] = SEGMENT_DP,
+};
+
+uint8_t segment_glyph(char c)
+{
+    return (unsigned char)c < sizeof(glyphs) ? glyphs[(unsigned char)c] : 0;
+}
+
+int segment_display_setup_pin(const segment_display_t *display, int gpio)
+{
+    if (gpio < 0 || gpio > SEGMENT_MAX_GPIO)
+    {
+        return SEGMENT_DISPLAY_ERROR_BAD_ARGUMENT;
+    }
+
+    if (display->direct)
+    {
+        rpi_gpio_set_select(gpio, RPI_GPIO_FUNC_OUT);
+    }
+    else if (rpi_gpio_setup(gpio, GPIO_OUT) != GPIO_SUCCESS)
+    {
+        perror("rpi_gpio_setup");
+        return SEGMENT_DISPLAY_ERROR_GPIO;
+    }
+
+    return SEGMENT_DISPLAY_SUCCESS;
+}
+
+int segment_display_init(segment_display_t *display, const segment_pins_t *pins)
+{
+    if (display == NULL || pins == NULL)
+    {
+        return SEGMENT_DISPLAY_ERROR_BAD_ARGUMENT;
+    }
+
+    memset(display, 0, sizeof(*display));
+    display->pins = *pins;
+    display->direct = rpi_gpio_regs != NULL;
+    display->shown = -1;
+
+    for (unsigned i = 0; i < SEGMENT_COUNT; i++)
+    {
+        int status = segment_display_setup_pin(display, pins->pins[i]);
+        if (status != SEGMENT_DISPLAY_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    // A segment is lit by driving its pin high, or low on an active low display
+    for (unsigned pattern = 0; pattern < SEGMENT_PATTERNS; pattern++)
+    {
+        for (unsigned i = 0; i < SEGMENT_COUNT; i++)
+        {
+            uint32_t bit = 1u << pins->pins[i];
+            bool lit = pattern & (1u << i);
+
+            if (lit != pins->active_low)
+            {
+                display->set_mask[pattern] |= bit;
+            }
+            else
+            {
+                display->clear_mask[pattern] |= bit;
+            }
+        }
+    }
+
+    return SEGMENT_DISPLAY_SUCCESS;
+}
+
+int segment_display_show(segment_display_t *display, uint8_t segments)
+{
+    if (display->shown == segments)
+    {
+        return SEGMENT_DISPLAY_SUCCESS;
+    }
+
+    if (display->direct)
+    {
+        // Pins in neither mask keep their level: the two stores never disturb other users of the bank
+        __RPI_GPIO_REGS[RPI_GPIO_REG_GPSET0] = display->set_mask[segments];
+        __RPI_GPIO_REGS[RPI_GPIO_REG_GPCLR0] = display->clear_mask[segments];
+        display->shown = segments;
+        return SEGMENT_DISPLAY_SUCCESS;
+    }
+
+    // One message per pin: only send the segments that change
+    uint8_t changed = display->shown < 0 ? 0xFF : (uint8_t)(segments ^ display->shown);
+    for (unsigned i = 0; i < SEGMENT_COUNT; i++)
+    {
+        if (!(changed & (1u << i)))
+        {
+            continue;
+        }
+
+        int pin = display->pins.pins[i];
+        bool high = display->set_mask[segments] & (1u << pin);
+        if (rpi_gpio_output(pin, high ? GPIO_HIGH : GPIO_LOW) != GPIO_SUCCESS)
+        {
+            display->shown = -1; // Some pins may be out of date
+            return SEGMENT_DISPLAY_ERROR_GPIO;
+        }
+    }
+
+    display->shown = segments;
+    return SEGMENT_DISPLAY_SUCCESS;
+}
+
+int segment_display_write_pin(const segment_display_t *display, int gpio, bool high)
+{
+    if (display->direct)
+    {
+        if (high)
+        {
+            rpi_gpio_set(gpio);
+        }
+        else
+        {
+            rpi_gpio_clear(gpio);
+        }
+        return SEGMENT_DISPLAY_SUCCESS;
+    }
+
+    return rpi_gpio_output(gpio, high ? GPIO_HIGH : GPIO_LOW) == GPIO_SUCCESS ? SEGMENT_DISPLAY_SUCCESS
+                                                                             : SEGMENT_DISPLAY_ERROR_GPIO;
+}
@@ -4,6 +4,14 @@
 
 // The interface for a GPIO resource manager tailored for the Raspberry Pi's GPIO pins under QNX.
 #include "rpi_gpio.h"
+#include "segment_display.h" // Glyph table and segment pin writes
+
+// Pointer to the Raspberry Pi's GPIO registers, set if they can be mapped into our address space.
+// When it is set, the segment display writes a whole digit with one store to the set and one to the clear register.
+volatile uint32_t *rpi_gpio_regs;
+
+// Base address of the GPIO registers on the raspberry pi
+#define RPI_PERIPHERAL_BASE 0xfe000000
 
 // Define GPIO pins for each segment of the 7-segment display
 #define SEG_A GPIO19
@@ -15,57 +23,36 @@
 #define SEG_G GPIO6
 #define SEG_DP GPIO12
 
-// Segment configurations for digits 0-9 (Common Cathode display)
-// 1 = ON, 0 = OFF (Each list represents the segments that should be lit for a given number)
-int digits[10][8] = {
-    {1, 1, 1, 1, 1, 1, 0, 0},  // 0
-    {0, 1, 1, 0, 0, 0, 0, 0},  // 1
-    {1, 1, 0, 1, 1, 0, 1, 0},  // 2
-    {1, 1, 1, 1, 0, 0, 1, 0},  // 3
-    {0, 1, 1, 0, 0, 1, 1, 0},  // 4
-    {1, 0, 1, 1, 0, 1, 1, 0},  // 5
-    {1, 0, 1, 1, 1, 1, 1, 0},  // 6
-    {1, 1, 1, 0, 0, 0, 0, 0},  // 7
-    {1, 1, 1, 1, 1, 1, 1, 0},  // 8
-    {1, 1, 1, 1, 0, 1, 1, 1}   // 9 and decimal point
+// The segment pins, in the order A to G then DP (Common Cathode display: a segment is lit when its pin is high)
+static const segment_pins_t SEGMENT_PINS = {
+    .pins = {SEG_A, SEG_B, SEG_C, SEG_D, SEG_E, SEG_F, SEG_G, SEG_DP},
+    .active_low = false
 };
 
-// Initializes a GPIO pin as an output pin
-int init_gpio(int gpio_pin) {
-    if (rpi_gpio_setup(gpio_pin, GPIO_OUT)) {
-        perror("rpi_gpio_setup");
-        return -1;
-    }
-    return 0;
-}
-
 // Set the segments according to the digit to display
-int display_number(int num) {
+int display_number(segment_display_t *display, int num) {
     if (num < 0 || num > 9) {
         return -1;  // Invalid number
     }
 
-    // Set the corresponding segments for the number
-    int* pattern = digits[num];
-
-    rpi_gpio_output(SEG_A, pattern[0] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_B, pattern[1] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_C, pattern[2] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_D, pattern[3] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_E, pattern[4] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_F, pattern[5] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_G, pattern[6] ? GPIO_HIGH : GPIO_LOW);
-    rpi_gpio_output(SEG_DP, pattern[7] ? GPIO_HIGH : GPIO_LOW);
+    uint8_t segments = segment_glyph('0' + num);
+    if (num == 9) {
+        segments |= SEGMENT_DP; // 9 and decimal point
+    }
 
-    return 0;
+    return segment_display_show(display, segments) == SEGMENT_DISPLAY_SUCCESS ? 0 : -1;
 }
 
 int main() {
 
+    // Map the GPIO registers if we are allowed to; otherwise every pin goes through the GPIO resource manager
+    if (!rpi_gpio_map_regs(RPI_PERIPHERAL_BASE)) {
+        printf("GPIO registers not mapped, using the GPIO resource manager\n");
+    }
+
     // Initialize all GPIO pins for the 7-segment display
-    if (init_gpio(SEG_A) == -1 || init_gpio(SEG_B) == -1 || init_gpio(SEG_C) == -1 ||
-        init_gpio(SEG_D) == -1 || init_gpio(SEG_E) == -1 || init_gpio(SEG_F) == -1 ||
-        init_gpio(SEG_G) == -1 || init_gpio(SEG_DP) == -1) {
+    segment_display_t display;
+    if (segment_display_init(&display, &SEGMENT_PINS) != SEGMENT_DISPLAY_SUCCESS) {
         return EXIT_FAILURE;
     }
 
@@ -73,7 +60,7 @@ int main() {
     while (1) {
         for (int i = 0; i < 10; i++) {
             // Display the current digit
-            if (display_number(i) == -1) {
+            if (display_number(&display, i) == -1) {
                 return EXIT_FAILURE;
             }
 
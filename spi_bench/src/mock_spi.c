@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/iofunc.h>
+#include <sys/dispatch.h>
+#include <sys/mman.h>
+#include <hw/io-spi.h>
+#include "mock_spi.h"
+
+#define SPI_DEVICE_FILENAME_FORMAT "/dev/io-spi/spi%d/dev%d" // same as rpi_spi.c
+
+/* State of one emulated device; the attribute comes first so an OCB's attr pointer leads back to it */
+typedef struct
+{
+    iofunc_attr_t attr;
+    dispatch_t *dispatch;
+    spi_cfg_t cfg;
+    unsigned flags;
+} mock_device_t;
+
+static resmgr_connect_funcs_t mock_connect_funcs;
+static resmgr_io_funcs_t mock_io_funcs;
+static mock_device_t mock_devices[MOCK_SPI_MAX_DEVICES];
+static unsigned mock_device_count;
+
+/* Busy-wait for the time the exchange would keep the bus busy at the configured clock */
+static void hold_bus(const mock_device_t *device, uint32_t nbytes)
+{
+    if (!(device->flags & MOCK_SPI_TIMED) || device->cfg.clock_rate == 0)
+    {
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t start = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    uint64_t duration = (uint64_t)nbytes * 8 * 1000000000ULL / device->cfg.clock_rate;
+    uint64_t now;
+
+    do
+    {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        now = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    } while (now - start < duration);
+}
+
+static int mock_devctl(resmgr_context_t *ctp, io_devctl_t *msg, RESMGR_OCB_T *ocb)
+{
+    mock_device_t *device = (mock_device_t *)ocb->attr;
+
+    int status = iofunc_devctl_default(ctp, msg, ocb);
+    if (status != _RESMGR_DEFAULT)
+    {
+        return status;
+    }
+
+    // The request and reply headers share the message buffer, read the request first
+    void *data = _DEVCTL_DATA(msg->i);
+    uint32_t nbytes = msg->i.nbytes;
+    uint32_t reply_bytes = 0;
+
+    if (nbytes > sizeof(spi_xchng_t) + MOCK_SPI_MAX_XCHNG)
+    {
+        return E2BIG;
+    }
+
+    // Fetch any part of the request that did not fit in the receive buffer
+    if (sizeof(msg->i) + nbytes > (size_t)ctp->size)
+    {
+        if (resmgr_msgread(ctp, data, nbytes, sizeof(msg->i)) < 0)
+        {
+            return errno;
+        }
+    }
+
+    switch (msg->i.dcmd)
+    {
+    case DCMD_SPI_SET_CONFIG:
+        if (nbytes < sizeof(spi_cfg_t))
+        {
+            return EINVAL;
+        }
+        memcpy(&device->cfg, data, sizeof(spi_cfg_t));
+        break;
+
+    case DCMD_SPI_GET_DRVINFO:
+    {
+        spi_drvinfo_t *info = data;
+        memset(info, 0, sizeof(*info));
+        strcpy(info->name, "mock-spi");
+        info->feature = SPI_FEATURE_DMA;
+        reply_bytes = sizeof(*info);
+        break;
+    }
+
+    case DCMD_SPI_GET_DEVINFO:
+    {
+        spi_devinfo_t *info = data;
+        memset(info, 0, sizeof(*info));
+        strcpy(info->name, "loopback");
+        info->cfg = device->cfg;
+        reply_bytes = sizeof(*info);
+        break;
+    }
+
+    case DCMD_SPI_DATA_XCHNG:
+    {
+        // Loopback: the data written is the data read, and it is already in place
+        spi_xchng_t *xchng = data;
+        if (nbytes < sizeof(spi_xchng_t) || xchng->nbytes > nbytes - sizeof(spi_xchng_t))
+        {
+            return EINVAL;
+        }
+        hold_bus(device, xchng->nbytes);
+        reply_bytes = sizeof(spi_xchng_t) + xchng->nbytes;
+        break;
+    }
+
+    case DCMD_SPI_DMA_XCHNG:
+    {
+        // Loopback through physical memory: copy the write buffer into the read buffer
+        spi_dma_paddr_t *paddr = data;
+        if (nbytes < sizeof(spi_dma_paddr_t) || paddr->nbytes == 0)
+        {
+            return EINVAL;
+        }
+
+        void *tx = mmap_device_memory(NULL, paddr->nbytes, PROT_READ | PROT_NOCACHE, 0, paddr->wpaddr);
+        void *rx = mmap_device_memory(NULL, paddr->nbytes, PROT_READ | PROT_WRITE | PROT_NOCACHE, 0, paddr->rpaddr);
+        if (tx == MAP_FAILED || rx == MAP_FAILED)
+        {
+            int err = errno;
+            if (tx != MAP_FAILED)
+            {
+                munmap_device_memory(tx, paddr->nbytes);
+            }
+            if (rx != MAP_FAILED)
+            {
+                munmap_device_memory(rx, paddr->nbytes);
+            }
+            return err;
+        }
+
+        memcpy(rx, tx, paddr->nbytes);
+        munmap_device_memory(tx, paddr->nbytes);
+        munmap_device_memory(rx, paddr->nbytes);
+
+        hold_bus(device, paddr->nbytes);
+        break;
+    }
+
+    default:
+        return ENOSYS;
+    }
+
+    memset(&msg->o, 0, sizeof(msg->o));
+    msg->o.nbytes = reply_bytes;
+    return _RESMGR_PTR(ctp, &msg->o, sizeof(msg->o) + reply_bytes);
+}
+
+static void *mock_thread(void *arg)
+{
+    mock_device_t *device = arg;
+    dispatch_context_t *ctp = dispatch_context_alloc(device->dispatch);
+    if (ctp == NULL)
+    {
+        perror("dispatch_context_alloc");
+        return NULL;
+    }
+
+    for (;;)
+    {
+        if ((ctp = dispatch_block(ctp)) == NULL)
+        {
+            perror("dispatch_block");
+            return NULL;
+        }
+        dispatch_handler(ctp);
+    }
+
+    return NULL;
+}
+
+int mock_spi_start(unsigned bus_number, unsigned device_number, unsigned flags)
+{
+    char path[32];
+    snprintf(path, sizeof(path), SPI_DEVICE_FILENAME_FORMAT, bus_number, device_number);
+
+    if (mock_device_count >= MOCK_SPI_MAX_DEVICES)
+    {
+        return MOCK_SPI_ERROR_ATTACH;
+    }
+
+    mock_device_t *device = &mock_devices[mock_device_count];
+    device->flags = flags;
+
+    device->dispatch = dispatch_create();
+    if (device->dispatch == NULL)
+    {
+        perror("dispatch_create");
+        return MOCK_SPI_ERROR_ATTACH;
+    }
+
+    if (mock_device_count == 0)
+    {
+        iofunc_func_init(_RESMGR_CONNECT_NFUNCS, &mock_connect_funcs, _RESMGR_IO_NFUNCS, &mock_io_funcs);
+        mock_io_funcs.devctl = mock_devctl;
+    }
+    iofunc_attr_init(&device->attr, S_IFCHR | 0666, NULL, NULL);
+
+    // Large enough to receive the biggest exchange in one message
+    resmgr_attr_t resmgr_attr;
+    memset(&resmgr_attr, 0, sizeof(resmgr_attr));
+    resmgr_attr.nparts_max = 1;
+    resmgr_attr.msg_max_size = sizeof(io_devctl_t) + sizeof(spi_xchng_t) + MOCK_SPI_MAX_XCHNG;
+
+    if (resmgr_attach(device->dispatch, &resmgr_attr, path, _FTYPE_ANY, 0,
+                      &mock_connect_funcs, &mock_io_funcs, &device->attr) == -1)
+    {
+        perror("resmgr_attach");
+        return MOCK_SPI_ERROR_ATTACH;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, mock_thread, device) != EOK)
+    {
+        perror("pthread_create");
+        return MOCK_SPI_ERROR_THREAD;
+    }
+    pthread_detach(thread);
+
+    mock_device_count++;
+
+    return MOCK_SPI_SUCCESS;
+}
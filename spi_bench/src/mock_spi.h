@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MOCK_SPI_H
+#define MOCK_SPI_H
+
+/* Return codes for client API */
+#define MOCK_SPI_SUCCESS 0
+#define MOCK_SPI_ERROR_ATTACH -1
+#define MOCK_SPI_ERROR_THREAD -2
+
+#define MOCK_SPI_MAX_XCHNG 16384 // largest exchange accepted, in data bytes
+#define MOCK_SPI_MAX_DEVICES 4
+
+/* Options of mock_spi_start() */
+#define MOCK_SPI_TIMED 0x01 // hold each exchange for as long as the configured SPI clock would take
+
+/**
+ * Start a loopback SPI device in this process. It registers the path rpi_spi
+ * opens for bus_number/device_number and answers DCMD_SPI_DATA_XCHNG by
+ * returning the written data as the read data, so the cost of the message
+ * path can be measured without hardware. Up to MOCK_SPI_MAX_DEVICES devices
+ * can be started; each runs until the process exits.
+ *
+ * @param    bus_number      SPI bus number to emulate
+ * @param    device_number   SPI device number to emulate
+ *
+ * @returns  MOCK_SPI_SUCCESS       on success,
+ *           MOCK_SPI_ERROR_ATTACH  the path could not be registered (requires root),
+ *                                  or MOCK_SPI_MAX_DEVICES are already running
+ *           MOCK_SPI_ERROR_THREAD  the server thread could not be created
+ */
+int mock_spi_start(unsigned bus_number, unsigned device_number, unsigned flags);
+
+#endif
@@ -0,0 +1,1084 @@
+/*
+ * Copyright (c) 2024, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/neutrino.h>
+#include "public/rpi_spi.h"
+
+#define SPI_DEVICE_FILENAME_FORMAT "/dev/io-spi/spi%d/dev%d"
+
+#define MAX_SPI_BUSES 6
+#define MAX_SPI_BUS_DEVICES 10 // should be good enough to start with
+
+#define SPI_DISCARD_BUFFER_SIZE 256
+#define SPI_MAX_RECV_PARTS (2 * RPI_SPI_MAX_SEGMENTS) // read buffers plus discard chunks
+
+// Latency histogram: 8 linear sub-buckets per power of two, up to ~17s
+#define SPI_LATENCY_SUB_BITS 3
+#define SPI_LATENCY_BUCKETS 256
+
+static int spi_device_fd[MAX_SPI_BUSES][MAX_SPI_BUS_DEVICES] = {
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1}};
+
+// Receives the read data of segments that have no read buffer; its contents are never used
+static uint8_t spi_discard_buffer[SPI_DISCARD_BUFFER_SIZE];
+
+// Mutex protecting the SPI device file descriptors
+static pthread_mutex_t spi_fd_mutex;
+
+/* Queue of asynchronous requests of a bus and the worker thread executing them */
+typedef struct
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t submitted;            // signalled when a request is queued
+    pthread_cond_t completed;            // broadcast when a request completes
+    bool worker_started;
+    rpi_spi_request_t *head;
+    rpi_spi_request_t *tail;
+} spi_async_t;
+
+static spi_async_t spi_async[MAX_SPI_BUSES];
+
+/*
+ * Configuration cache: the configuration requested for each device and the
+ * one last sent to the driver. DCMD_SPI_SET_CONFIG is only issued when they
+ * differ, before the device's next exchange.
+ */
+typedef struct
+{
+    spi_cfg_t desired;
+    spi_cfg_t applied;
+    bool configured;         // a configuration was requested
+    bool applied_valid;      // the driver holds `applied`
+    atomic_bool pending;     // desired differs from applied, checked without the lock
+    uint64_t requests;
+    uint64_t set_configs;
+} spi_device_config_t;
+
+static spi_device_config_t spi_device_config[MAX_SPI_BUSES][MAX_SPI_BUS_DEVICES];
+
+/* DMA support of a device's driver, queried on the first rpi_spi_transfer() */
+typedef enum
+{
+    SPI_DMA_UNKNOWN,
+    SPI_DMA_SUPPORTED,
+    SPI_DMA_UNSUPPORTED
+} spi_dma_support_t;
+
+// Atomic: rpi_spi_transfer() on the same device may run in several threads
+static _Atomic spi_dma_support_t spi_dma_support[MAX_SPI_BUSES][MAX_SPI_BUS_DEVICES];
+static uint32_t spi_dma_threshold[MAX_SPI_BUSES][MAX_SPI_BUS_DEVICES];
+static pthread_mutex_t spi_config_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Per-bus arbiter: exchanges of the threads of this process are granted the
+ * bus one at a time, highest priority class first and in request order within
+ * a class. Transfer lists are arbitrated per exchange, so a short urgent
+ * transfer can run between the segments of a long bulk update.
+ */
+typedef struct
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool busy;
+    unsigned waiting[SPI_PRIORITY_COUNT];        // requesters queued per class
+    uint64_t next_ticket[SPI_PRIORITY_COUNT];    // FIFO order within a class
+    uint64_t serving[SPI_PRIORITY_COUNT];
+
+    // Request-to-completion latency per class
+    uint64_t histogram[SPI_PRIORITY_COUNT][SPI_LATENCY_BUCKETS];
+    uint64_t count[SPI_PRIORITY_COUNT];
+    uint64_t max_ns[SPI_PRIORITY_COUNT];
+} spi_bus_t;
+
+/* An exchange holding the bus: the class it was queued in is the one its latency is accounted to */
+typedef struct
+{
+    rpi_spi_priority_t priority;
+    uint64_t request_ns;
+} spi_bus_claim_t;
+
+static spi_bus_t spi_buses[MAX_SPI_BUSES];
+static rpi_spi_priority_t spi_device_priority[MAX_SPI_BUSES][MAX_SPI_BUS_DEVICES];
+static pthread_once_t spi_bus_once = PTHREAD_ONCE_INIT;
+
+static void spi_bus_init(void)
+{
+    for (unsigned bus = 0; bus < MAX_SPI_BUSES; bus++)
+    {
+        pthread_mutex_init(&spi_buses[bus].mutex, NULL);
+        pthread_cond_init(&spi_buses[bus].cond, NULL);
+        pthread_mutex_init(&spi_async[bus].mutex, NULL);
+        pthread_cond_init(&spi_async[bus].submitted, NULL);
+        pthread_cond_init(&spi_async[bus].completed, NULL);
+
+        for (unsigned device = 0; device < MAX_SPI_BUS_DEVICES; device++)
+        {
+            spi_device_priority[bus][device] = SPI_PRIORITY_NORMAL;
+            spi_dma_threshold[bus][device] = RPI_SPI_DMA_THRESHOLD_DEFAULT;
+        }
+    }
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned latency_bucket(uint64_t ns)
+{
+    if (ns < (1 << SPI_LATENCY_SUB_BITS))
+    {
+        return ns;
+    }
+
+    unsigned exponent = 63 - __builtin_clzll(ns);
+    unsigned bucket = (exponent - SPI_LATENCY_SUB_BITS + 1) << SPI_LATENCY_SUB_BITS |
+                      ((ns >> (exponent - SPI_LATENCY_SUB_BITS)) & ((1 << SPI_LATENCY_SUB_BITS) - 1));
+
+    return bucket < SPI_LATENCY_BUCKETS ? bucket : SPI_LATENCY_BUCKETS - 1;
+}
+
+/* Largest latency that falls in a bucket */
+static uint64_t latency_bucket_limit(unsigned bucket)
+{
+    if (bucket < (1 << SPI_LATENCY_SUB_BITS))
+    {
+        return bucket;
+    }
+
+    unsigned exponent = (bucket >> SPI_LATENCY_SUB_BITS) + SPI_LATENCY_SUB_BITS - 1;
+    uint64_t mantissa = (1 << SPI_LATENCY_SUB_BITS) + (bucket & ((1 << SPI_LATENCY_SUB_BITS) - 1)) + 1;
+
+    return (mantissa << (exponent - SPI_LATENCY_SUB_BITS)) - 1;
+}
+
+/* Wait until this exchange may use the bus; returns its class and request time */
+static spi_bus_claim_t
+spi_bus_acquire(unsigned bus_number, unsigned device_number)
+{
+    pthread_once(&spi_bus_once, spi_bus_init);
+
+    spi_bus_t *bus = &spi_buses[bus_number];
+    rpi_spi_priority_t priority = spi_device_priority[bus_number][device_number];
+    uint64_t request_ns = now_ns();
+
+    pthread_mutex_lock(&bus->mutex);
+
+    uint64_t ticket = bus->next_ticket[priority]++;
+    bus->waiting[priority]++;
+
+    for (;;)
+    {
+        bool higher_waiting = false;
+        for (unsigned p = priority + 1; p < SPI_PRIORITY_COUNT; p++)
+        {
+            higher_waiting |= bus->waiting[p] > 0;
+        }
+
+        if (!bus->busy && !higher_waiting && ticket == bus->serving[priority])
+        {
+            break;
+        }
+        pthread_cond_wait(&bus->cond, &bus->mutex);
+    }
+
+    bus->waiting[priority]--;
+    bus->serving[priority]++;
+    bus->busy = true;
+
+    pthread_mutex_unlock(&bus->mutex);
+
+    return (spi_bus_claim_t){.priority = priority, .request_ns = request_ns};
+}
+
+/* Hand the bus to the next requester and account for the latency of the exchange */
+static void
+spi_bus_release(unsigned bus_number, const spi_bus_claim_t *claim)
+{
+    spi_bus_t *bus = &spi_buses[bus_number];
+    rpi_spi_priority_t priority = claim->priority;
+    uint64_t latency_ns = now_ns() - claim->request_ns;
+
+    pthread_mutex_lock(&bus->mutex);
+
+    bus->histogram[priority][latency_bucket(latency_ns)]++;
+    bus->count[priority]++;
+    if (latency_ns > bus->max_ns[priority])
+    {
+        bus->max_ns[priority] = latency_ns;
+    }
+
+    bus->busy = false;
+    pthread_cond_broadcast(&bus->cond);
+
+    pthread_mutex_unlock(&bus->mutex);
+}
+
+/* Open the SPI device */
+static int
+open_spi_device_fd(unsigned bus_number, unsigned device_number)
+{
+    char spi_device_name[20] = {0};
+
+    sprintf(spi_device_name, SPI_DEVICE_FILENAME_FORMAT, bus_number, device_number);
+
+    pthread_mutex_lock(&spi_fd_mutex);
+
+    if (spi_device_fd[bus_number][device_number] == -1)
+    {
+        spi_device_fd[bus_number][device_number] = open(spi_device_name, O_RDWR);
+        if (spi_device_fd[bus_number][device_number] < 0)
+        {
+            perror("open");
+            return SPI_ERROR_NOT_CONNECTED;
+        }
+    }
+
+    pthread_mutex_unlock(&spi_fd_mutex);
+
+    return SPI_SUCCESS;
+}
+
+/* Close the SPI device */
+static int
+close_spi_device_fd(unsigned bus_number, unsigned device_number)
+{
+    pthread_mutex_lock(&spi_fd_mutex);
+
+    if (spi_device_fd[bus_number][device_number] != -1)
+    {
+        int err = close(spi_device_fd[bus_number][device_number]);
+        if (err != EOK)
+        {
+            perror("close");
+            return SPI_ERROR_NOT_CONNECTED;
+        }
+        spi_device_fd[bus_number][device_number] = -1;
+    }
+
+    pthread_mutex_unlock(&spi_fd_mutex);
+
+    return SPI_SUCCESS;
+}
+
+/* Send the requested configuration of a device to the driver if it is not the active one */
+static int
+sync_config(unsigned bus_number, unsigned device_number)
+{
+    spi_device_config_t *config = &spi_device_config[bus_number][device_number];
+    int result = SPI_SUCCESS;
+
+    if (!atomic_load(&config->pending))
+    {
+        return SPI_SUCCESS;
+    }
+
+    pthread_mutex_lock(&spi_config_mutex);
+
+    if (atomic_load(&config->pending))
+    {
+        spi_cfg_t cfg = config->desired;
+
+        int err = devctl(spi_device_fd[bus_number][device_number], DCMD_SPI_SET_CONFIG, &cfg, sizeof(spi_cfg_t), NULL);
+        if (err != EOK)
+        {
+            perror("devctl");
+            fprintf(stderr, "error: %d\n", err);
+            result = SPI_ERROR_OPERATION_FAILED;
+        }
+        else
+        {
+            config->applied = config->desired;
+            config->applied_valid = true;
+            config->set_configs++;
+            atomic_store(&config->pending, false);
+        }
+    }
+
+    pthread_mutex_unlock(&spi_config_mutex);
+
+    return result;
+}
+
+int rpi_spi_get_driver_info(unsigned bus_number, unsigned device_number, spi_drvinfo_t *driver_info)
+{
+    int err;
+
+    if (open_spi_device_fd(bus_number, device_number))
+    {
+        perror("open_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    if (driver_info == NULL)
+    {
+        perror("invalid driver_info");
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    // Send the SPI message
+    err = devctl(spi_device_fd[bus_number][device_number], DCMD_SPI_GET_DRVINFO, driver_info, sizeof(spi_drvinfo_t), NULL);
+    if (err != EOK)
+    {
+        perror("devctl");
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_get_device_info(unsigned bus_number, unsigned device_number, spi_devinfo_t *device_info)
+{
+    int err;
+
+    if (open_spi_device_fd(bus_number, device_number))
+    {
+        perror("open_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    if (device_info == NULL)
+    {
+        perror("invalid device_info");
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    // Send the SPI message
+    err = devctl(spi_device_fd[bus_number][device_number], DCMD_SPI_GET_DEVINFO, device_info, sizeof(spi_devinfo_t), NULL);
+    if (err != EOK)
+    {
+        perror("devctl");
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_set_config(unsigned bus_number, unsigned device_number, unsigned mode, uint32_t spi_device_speed_hz)
+{
+    if (bus_number >= MAX_SPI_BUSES || device_number >= MAX_SPI_BUS_DEVICES)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    spi_device_config_t *config = &spi_device_config[bus_number][device_number];
+
+    pthread_mutex_lock(&spi_config_mutex);
+
+    config->desired.mode = mode;
+    config->desired.clock_rate = spi_device_speed_hz;
+    config->configured = true;
+    config->requests++;
+
+    // Nothing to send if the driver already runs this configuration
+    bool differs = !config->applied_valid ||
+                   config->applied.mode != mode ||
+                   config->applied.clock_rate != spi_device_speed_hz;
+    atomic_store(&config->pending, differs);
+
+    pthread_mutex_unlock(&spi_config_mutex);
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_configure_device(unsigned bus_number, unsigned device_number, unsigned mode, uint32_t spi_device_speed_hz)
+{
+    if (open_spi_device_fd(bus_number, device_number))
+    {
+        perror("open_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    // Record the configuration and apply it now, so errors are reported to the caller
+    rpi_spi_set_config(bus_number, device_number, mode, spi_device_speed_hz);
+
+    return sync_config(bus_number, device_number);
+}
+
+int rpi_spi_get_config_stats(unsigned bus_number, unsigned device_number, rpi_spi_config_stats_t *stats)
+{
+    if (bus_number >= MAX_SPI_BUSES || device_number >= MAX_SPI_BUS_DEVICES || stats == NULL)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    spi_device_config_t *config = &spi_device_config[bus_number][device_number];
+
+    pthread_mutex_lock(&spi_config_mutex);
+    stats->requests = config->requests;
+    stats->set_configs = config->set_configs;
+    pthread_mutex_unlock(&spi_config_mutex);
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_write_read_data(unsigned bus_number, unsigned device_number,
+                            uint8_t *write_data_buffer,
+                            uint8_t *read_data_buffer,
+                            uint32_t data_size)
+{
+    int err;
+
+    if (open_spi_device_fd(bus_number, device_number))
+    {
+        perror("open_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    if (data_size < 1)
+    {
+        perror("invalid data size");
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    if (write_data_buffer == NULL)
+    {
+        perror("invalid write data buffer pointer");
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    // Send the exchange header followed directly by the caller's buffers; the reply
+    // is scattered back into a header and the read buffer, so nothing is copied here
+    spi_xchng_t xchng_header = {.nbytes = data_size};
+    iov_t send_iov[2];
+    iov_t recv_iov[2];
+    int recv_parts = 1;
+
+    SETIOV(&send_iov[0], &xchng_header, sizeof(spi_xchng_t));
+    SETIOV(&send_iov[1], write_data_buffer, data_size);
+    SETIOV(&recv_iov[0], &xchng_header, sizeof(spi_xchng_t));
+
+    // Without a read buffer only the header is received and the read data is dropped
+    if (read_data_buffer != NULL)
+    {
+        SETIOV(&recv_iov[1], read_data_buffer, data_size);
+        recv_parts = 2;
+    }
+
+    if (sync_config(bus_number, device_number) != SPI_SUCCESS)
+    {
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    // Send the SPI message
+    spi_bus_claim_t claim = spi_bus_acquire(bus_number, device_number);
+    err = devctlv(spi_device_fd[bus_number][device_number], DCMD_SPI_DATA_XCHNG, 2, recv_parts, send_iov, recv_iov, NULL);
+    spi_bus_release(bus_number, &claim);
+    if (err != EOK)
+    {
+        fprintf(stderr, "error: %d\n", err);
+        perror("devctlv");
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_exchange(unsigned bus_number, unsigned device_number, spi_xchng_t *xchng, uint32_t data_size)
+{
+    int err;
+
+    if (open_spi_device_fd(bus_number, device_number))
+    {
+        perror("open_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    if (data_size < 1)
+    {
+        perror("invalid data size");
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    if (xchng == NULL)
+    {
+        perror("invalid exchange buffer pointer");
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    // The caller's buffer already has room for the header: exchange it in place
+    xchng->nbytes = data_size;
+
+    if (sync_config(bus_number, device_number) != SPI_SUCCESS)
+    {
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    // Send the SPI message
+    spi_bus_claim_t claim = spi_bus_acquire(bus_number, device_number);
+    err = devctl(spi_device_fd[bus_number][device_number], DCMD_SPI_DATA_XCHNG, xchng, RPI_SPI_XCHNG_SIZE(data_size), NULL);
+    spi_bus_release(bus_number, &claim);
+    if (err != EOK)
+    {
+        fprintf(stderr, "error: %d\n", err);
+        perror("devctl");
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    return SPI_SUCCESS;
+}
+
+/* Index of the last segment of a run with a read buffer, or -1 if nothing is read back */
+static int last_read_segment(const rpi_spi_segment_t *segments, unsigned segment_count)
+{
+    for (int i = (int)segment_count - 1; i >= 0; i--)
+    {
+        if (segments[i].rx != NULL)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Receive parts a run needs past the header: its read buffers, and discard chunks for the segments before the last read */
+static unsigned run_recv_parts(const rpi_spi_segment_t *segments, unsigned segment_count)
+{
+    int last_read = last_read_segment(segments, segment_count);
+    unsigned parts = 0;
+
+    for (int i = 0; i <= last_read; i++)
+    {
+        if (segments[i].rx != NULL)
+        {
+            parts++;
+        }
+        else
+        {
+            parts += segments[i].len / SPI_DISCARD_BUFFER_SIZE + (segments[i].len % SPI_DISCARD_BUFFER_SIZE != 0);
+        }
+    }
+    return parts;
+}
+
+/*
+ * Exchange a run of segments in one devctlv: CS stays asserted from the first byte to the last.
+ * The run must have been checked with run_recv_parts().
+ */
+static int
+exchange_segments(unsigned bus_number, unsigned device_number, const rpi_spi_segment_t *segments, unsigned segment_count)
+{
+    spi_xchng_t xchng_header = {.nbytes = 0};
+    iov_t send_iov[1 + RPI_SPI_MAX_SEGMENTS];
+    iov_t recv_iov[1 + SPI_MAX_RECV_PARTS];
+    int send_parts = 1;
+    int recv_parts = 1;
+    int last_read = last_read_segment(segments, segment_count);
+
+    SETIOV(&send_iov[0], &xchng_header, sizeof(spi_xchng_t));
+    SETIOV(&recv_iov[0], &xchng_header, sizeof(spi_xchng_t));
+
+    for (unsigned i = 0; i < segment_count; i++)
+    {
+        const rpi_spi_segment_t *segment = &segments[i];
+
+        xchng_header.nbytes += segment->len;
+        SETIOV(&send_iov[send_parts++], segment->tx, segment->len);
+
+        // Nothing is received past the last read buffer
+        if ((int)i > last_read)
+        {
+            continue;
+        }
+
+        if (segment->rx != NULL)
+        {
+            SETIOV(&recv_iov[recv_parts++], segment->rx, segment->len);
+            continue;
+        }
+
+        // Skip over read data nobody wants before a later read buffer of the run
+        for (uint32_t offset = 0; offset < segment->len; offset += SPI_DISCARD_BUFFER_SIZE)
+        {
+            uint32_t chunk = segment->len - offset;
+            if (chunk > SPI_DISCARD_BUFFER_SIZE)
+            {
+                chunk = SPI_DISCARD_BUFFER_SIZE;
+            }
+            SETIOV(&recv_iov[recv_parts++], spi_discard_buffer, chunk);
+        }
+    }
+
+    spi_bus_claim_t claim = spi_bus_acquire(bus_number, device_number);
+    int err = devctlv(spi_device_fd[bus_number][device_number], DCMD_SPI_DATA_XCHNG, send_parts, recv_parts, send_iov, recv_iov, NULL);
+    spi_bus_release(bus_number, &claim);
+    if (err != EOK)
+    {
+        fprintf(stderr, "error: %d\n", err);
+        perror("devctlv");
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_transfer_list(unsigned bus_number, unsigned device_number,
+                          const rpi_spi_segment_t *segments,
+                          unsigned segment_count)
+{
+    if (open_spi_device_fd(bus_number, device_number))
+    {
+        perror("open_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    if (segments == NULL || segment_count < 1)
+    {
+        perror("invalid segment list");
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    // Validate the whole list first so that an invalid segment or run cannot leave it half sent
+    unsigned run_length = 0;
+    for (unsigned i = 0; i < segment_count; i++)
+    {
+        if (segments[i].tx == NULL || segments[i].len < 1 || ++run_length > RPI_SPI_MAX_SEGMENTS)
+        {
+            perror("invalid segment");
+            return SPI_ERROR_BAD_ARGUMENT;
+        }
+
+        if ((segments[i].flags & SPI_SEGMENT_CS_DEASSERT) || i == segment_count - 1)
+        {
+            if (run_recv_parts(&segments[i + 1 - run_length], run_length) > SPI_MAX_RECV_PARTS)
+            {
+                fprintf(stderr, "too much data to skip before a read buffer\n");
+                return SPI_ERROR_BAD_ARGUMENT;
+            }
+            run_length = 0;
+        }
+    }
+
+    if (sync_config(bus_number, device_number) != SPI_SUCCESS)
+    {
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    // Each run of segments up to one that deasserts CS (or the end of the list) is one exchange
+    unsigned first = 0;
+    for (unsigned i = 0; i < segment_count; i++)
+    {
+        if ((segments[i].flags & SPI_SEGMENT_CS_DEASSERT) || i == segment_count - 1)
+        {
+            int err = exchange_segments(bus_number, device_number, &segments[first], i - first + 1);
+            if (err != SPI_SUCCESS)
+            {
+                return err;
+            }
+            first = i + 1;
+        }
+    }
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_dma_alloc(rpi_spi_dma_buffer_t *buffer, uint32_t size)
+{
+    if (buffer == NULL || size < 1)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    memset(buffer, 0, sizeof(*buffer));
+
+    // One physically contiguous, uncached block holds both buffers
+    uint8_t *memory = mmap(NULL, 2 * (size_t)size, PROT_READ | PROT_WRITE | PROT_NOCACHE,
+                           MAP_PHYS | MAP_ANON | MAP_PRIVATE, NOFD, 0);
+    if (memory == MAP_FAILED)
+    {
+        perror("mmap");
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    off64_t paddr;
+    if (mem_offset64(memory, NOFD, 2 * (size_t)size, &paddr, NULL) == -1)
+    {
+        perror("mem_offset64");
+        munmap(memory, 2 * (size_t)size);
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    buffer->tx = memory;
+    buffer->rx = memory + size;
+    buffer->size = size;
+    buffer->tx_paddr = paddr;
+    buffer->rx_paddr = paddr + size;
+
+    return SPI_SUCCESS;
+}
+
+void rpi_spi_dma_free(rpi_spi_dma_buffer_t *buffer)
+{
+    if (buffer != NULL && buffer->tx != NULL)
+    {
+        munmap(buffer->tx, 2 * (size_t)buffer->size);
+        memset(buffer, 0, sizeof(*buffer));
+    }
+}
+
+int rpi_spi_set_dma_threshold(unsigned bus_number, unsigned device_number, uint32_t threshold)
+{
+    if (bus_number >= MAX_SPI_BUSES || device_number >= MAX_SPI_BUS_DEVICES)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    pthread_once(&spi_bus_once, spi_bus_init);
+    spi_dma_threshold[bus_number][device_number] = threshold;
+
+    return SPI_SUCCESS;
+}
+
+/*
+ * Whether the driver of a device can exchange data with DMA; asked once and
+ * remembered. Threads racing on the first transfer may each ask the driver,
+ * which gives them all the same answer.
+ */
+static bool
+dma_supported(unsigned bus_number, unsigned device_number)
+{
+    _Atomic spi_dma_support_t *cached = &spi_dma_support[bus_number][device_number];
+    spi_dma_support_t support = atomic_load(cached);
+
+    if (support == SPI_DMA_UNKNOWN)
+    {
+        spi_drvinfo_t info;
+        bool dma = rpi_spi_get_driver_info(bus_number, device_number, &info) == SPI_SUCCESS &&
+                   (info.feature & SPI_FEATURE_DMA);
+        support = dma ? SPI_DMA_SUPPORTED : SPI_DMA_UNSUPPORTED;
+        atomic_store(cached, support);
+    }
+
+    return support == SPI_DMA_SUPPORTED;
+}
+
+int rpi_spi_transfer(unsigned bus_number, unsigned device_number, rpi_spi_dma_buffer_t *buffer, uint32_t data_size)
+{
+    if (bus_number >= MAX_SPI_BUSES || device_number >= MAX_SPI_BUS_DEVICES)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    if (buffer == NULL || buffer->tx == NULL || data_size < 1 || data_size > buffer->size)
+    {
+        perror("invalid DMA buffer or data size");
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    pthread_once(&spi_bus_once, spi_bus_init);
+
+    // Below the threshold setting up the DMA costs more than copying the data through the message
+    if (data_size < spi_dma_threshold[bus_number][device_number] || !dma_supported(bus_number, device_number))
+    {
+        return rpi_spi_write_read_data(bus_number, device_number, buffer->tx, buffer->rx, data_size);
+    }
+
+    if (sync_config(bus_number, device_number) != SPI_SUCCESS)
+    {
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    // Only the physical addresses travel in the message; the driver moves the data
+    spi_dma_paddr_t paddr = {
+        .rpaddr = buffer->rx_paddr,
+        .wpaddr = buffer->tx_paddr,
+        .nbytes = data_size};
+
+    spi_bus_claim_t claim = spi_bus_acquire(bus_number, device_number);
+    int err = devctl(spi_device_fd[bus_number][device_number], DCMD_SPI_DMA_XCHNG, &paddr, sizeof(paddr), NULL);
+    spi_bus_release(bus_number, &claim);
+    if (err != EOK)
+    {
+        fprintf(stderr, "error: %d\n", err);
+        perror("devctl");
+        return SPI_ERROR_OPERATION_FAILED;
+    }
+
+    return SPI_SUCCESS;
+}
+
+/* Bus worker: executes the queued requests of its bus one after the other */
+static void *
+spi_async_worker(void *arg)
+{
+    unsigned bus_number = (unsigned)(uintptr_t)arg;
+    spi_async_t *async = &spi_async[bus_number];
+
+    for (;;)
+    {
+        pthread_mutex_lock(&async->mutex);
+        while (async->head == NULL)
+        {
+            pthread_cond_wait(&async->submitted, &async->mutex);
+        }
+
+        rpi_spi_request_t *request = async->head;
+        async->head = request->next;
+        if (async->head == NULL)
+        {
+            async->tail = NULL;
+        }
+        pthread_mutex_unlock(&async->mutex);
+
+        request->result = rpi_spi_transfer_list(bus_number, request->device_number,
+                                                request->segments, request->segment_count);
+
+        if (request->callback != NULL)
+        {
+            request->callback(request, request->callback_arg);
+        }
+
+        // The request may be reused as soon as it is marked complete, so the event is copied first
+        struct sigevent event = request->event;
+
+        pthread_mutex_lock(&async->mutex);
+        request->busy = false;
+        pthread_cond_broadcast(&async->completed);
+        pthread_mutex_unlock(&async->mutex);
+
+        if (event.sigev_notify == SIGEV_PULSE)
+        {
+            MsgSendPulsePtr(event.sigev_coid, event.sigev_priority, event.sigev_code, event.sigev_value.sival_ptr);
+        }
+    }
+
+    return NULL;
+}
+
+int rpi_spi_submit(unsigned bus_number, rpi_spi_request_t *request)
+{
+    if (bus_number >= MAX_SPI_BUSES || request == NULL || request->device_number >= MAX_SPI_BUS_DEVICES ||
+        request->segments == NULL || request->segment_count < 1)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    // Open the device now so a missing device is reported to the submitter
+    if (open_spi_device_fd(bus_number, request->device_number))
+    {
+        perror("open_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    pthread_once(&spi_bus_once, spi_bus_init);
+
+    spi_async_t *async = &spi_async[bus_number];
+    int result = SPI_SUCCESS;
+
+    pthread_mutex_lock(&async->mutex);
+
+    if (request->busy)
+    {
+        result = SPI_ERROR_BAD_ARGUMENT;
+    }
+    else if (!async->worker_started)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, spi_async_worker, (void *)(uintptr_t)bus_number) != EOK)
+        {
+            perror("pthread_create");
+            result = SPI_ERROR_OPERATION_FAILED;
+        }
+        else
+        {
+            pthread_detach(thread);
+            async->worker_started = true;
+        }
+    }
+
+    if (result == SPI_SUCCESS)
+    {
+        request->bus_number = bus_number;
+        request->busy = true;
+        request->next = NULL;
+
+        if (async->tail != NULL)
+        {
+            async->tail->next = request;
+        }
+        else
+        {
+            async->head = request;
+        }
+        async->tail = request;
+
+        pthread_cond_signal(&async->submitted);
+    }
+
+    pthread_mutex_unlock(&async->mutex);
+
+    return result;
+}
+
+int rpi_spi_wait(rpi_spi_request_t *request)
+{
+    if (request == NULL || request->bus_number >= MAX_SPI_BUSES)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    pthread_once(&spi_bus_once, spi_bus_init);
+
+    spi_async_t *async = &spi_async[request->bus_number];
+
+    pthread_mutex_lock(&async->mutex);
+    while (request->busy)
+    {
+        pthread_cond_wait(&async->completed, &async->mutex);
+    }
+    pthread_mutex_unlock(&async->mutex);
+
+    return request->result;
+}
+
+bool rpi_spi_is_complete(rpi_spi_request_t *request)
+{
+    // A request that was never submitted has nothing pending
+    if (request == NULL || request->bus_number >= MAX_SPI_BUSES)
+    {
+        return true;
+    }
+
+    pthread_once(&spi_bus_once, spi_bus_init);
+
+    spi_async_t *async = &spi_async[request->bus_number];
+
+    pthread_mutex_lock(&async->mutex);
+    bool busy = request->busy;
+    pthread_mutex_unlock(&async->mutex);
+
+    return !busy;
+}
+
+int rpi_spi_set_priority(unsigned bus_number, unsigned device_number, rpi_spi_priority_t priority)
+{
+    if (bus_number >= MAX_SPI_BUSES || device_number >= MAX_SPI_BUS_DEVICES || priority >= SPI_PRIORITY_COUNT)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    pthread_once(&spi_bus_once, spi_bus_init);
+
+    // Changed under the bus lock so a queued exchange of the device is accounted consistently
+    pthread_mutex_lock(&spi_buses[bus_number].mutex);
+    spi_device_priority[bus_number][device_number] = priority;
+    pthread_mutex_unlock(&spi_buses[bus_number].mutex);
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_get_latency_stats(unsigned bus_number, rpi_spi_priority_t priority, rpi_spi_latency_stats_t *stats)
+{
+    if (bus_number >= MAX_SPI_BUSES || priority >= SPI_PRIORITY_COUNT || stats == NULL)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    pthread_once(&spi_bus_once, spi_bus_init);
+
+    spi_bus_t *bus = &spi_buses[bus_number];
+    static const unsigned permille[] = {500, 900, 990};
+    uint64_t *results[] = {&stats->p50_ns, &stats->p90_ns, &stats->p99_ns};
+
+    pthread_mutex_lock(&bus->mutex);
+
+    stats->count = bus->count[priority];
+    stats->max_ns = bus->max_ns[priority];
+
+    // Each percentile is reported as the upper limit of the bucket it falls in (at most the maximum)
+    for (unsigned i = 0; i < sizeof(permille) / sizeof(permille[0]); i++)
+    {
+        uint64_t target = (stats->count * permille[i] + 999) / 1000;
+        uint64_t seen = 0;
+
+        *results[i] = 0;
+        for (unsigned bucket = 0; bucket < SPI_LATENCY_BUCKETS && target > 0; bucket++)
+        {
+            seen += bus->histogram[priority][bucket];
+            if (seen >= target)
+            {
+                uint64_t limit = latency_bucket_limit(bucket);
+                *results[i] = limit < stats->max_ns ? limit : stats->max_ns;
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&bus->mutex);
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_reset_latency_stats(unsigned bus_number)
+{
+    if (bus_number >= MAX_SPI_BUSES)
+    {
+        return SPI_ERROR_BAD_ARGUMENT;
+    }
+
+    pthread_once(&spi_bus_once, spi_bus_init);
+
+    spi_bus_t *bus = &spi_buses[bus_number];
+
+    pthread_mutex_lock(&bus->mutex);
+    memset(bus->histogram, 0, sizeof(bus->histogram));
+    memset(bus->count, 0, sizeof(bus->count));
+    memset(bus->max_ns, 0, sizeof(bus->max_ns));
+    pthread_mutex_unlock(&bus->mutex);
+
+    return SPI_SUCCESS;
+}
+
+int rpi_spi_cleanup_device(unsigned bus_number, unsigned device_number)
+{
+    if (bus_number < MAX_SPI_BUSES && device_number < MAX_SPI_BUS_DEVICES)
+    {
+        spi_device_config_t *config = &spi_device_config[bus_number][device_number];
+
+        // A reopened device gets its configuration again before its first exchange
+        pthread_mutex_lock(&spi_config_mutex);
+        config->applied_valid = false;
+        atomic_store(&config->pending, config->configured);
+        pthread_mutex_unlock(&spi_config_mutex);
+    }
+
+    if (close_spi_device_fd(bus_number, device_number))
+    {
+        perror("close_spi_device_fd");
+        return SPI_ERROR_NOT_CONNECTED;
+    }
+
+    return SPI_SUCCESS;
+}
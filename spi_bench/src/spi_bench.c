@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "rpi_spi.h"     // SPI interface header
+#include "mock_spi.h"    // Loopback SPI device
+
+// The mock device is registered on a bus number the Raspberry Pi does not use
+#define BUS 5
+#define DEVICE 0
+#define SPI_SPEED 1000000
+
+#define DEFAULT_ITERATIONS 100000
+#define MAX_TRANSFER 64
+
+// Arbitration case: a display and an ADC sharing one bus, timed at the SPI clock
+#define DISPLAY_DEVICE 1
+#define ADC_DEVICE 2
+#define DISPLAY_ROWS 8
+#define DISPLAY_ROW_BYTES 8      // one row of a chain of four MAX7219 modules
+#define ADC_PERIOD_NS 1000000    // one MCP3008 channel pair per millisecond
+#define ARBITRATION_SECONDS 2
+
+// DMA crossover sweep: powers of two up to 4 KB
+#define SWEEP_MIN 16
+#define SWEEP_MAX 4096
+
+// Transfer list limits: write-only data past what can be skipped ahead of a read buffer (about 8 KB)
+#define LONG_SEGMENT 9000
+#define TAIL_READ 16
+
+typedef int (*transfer_fn)(uint8_t *tx, uint8_t *rx, uint32_t size);
+
+static int legacy_fd = -1;
+static uint8_t xchng_buffer[RPI_SPI_XCHNG_SIZE(MAX_TRANSFER)];
+
+// The original exchange path: allocate a message and copy the data in and out byte by byte
+static int transfer_legacy(uint8_t *tx, uint8_t *rx, uint32_t size) {
+    spi_xchng_t *msg = malloc(sizeof(spi_xchng_t) + size);
+    if (!msg) return -1;
+
+    msg->nbytes = size;
+    for (int i = 0; i < size; i++) {
+        msg->data[i] = tx[i];
+    }
+
+    int err = devctl(legacy_fd, DCMD_SPI_DATA_XCHNG, msg, sizeof(spi_xchng_t) + size, NULL);
+    if (err == EOK && rx != NULL) {
+        for (int i = 0; i < size; i++) {
+            rx[i] = msg->data[i];
+        }
+    }
+
+    free(msg);
+    return err == EOK ? 0 : -1;
+}
+
+// Vectored exchange straight from/to the caller's buffers
+static int transfer_vectored(uint8_t *tx, uint8_t *rx, uint32_t size) {
+    return rpi_spi_write_read_data(BUS, DEVICE, tx, rx, size);
+}
+
+// Write-only exchange, as used for display commands
+static int transfer_write_only(uint8_t *tx, uint8_t *rx, uint32_t size) {
+    return rpi_spi_write_read_data(BUS, DEVICE, tx, NULL, size);
+}
+
+// In-place exchange in a buffer that already has room for the header
+static int transfer_in_place(uint8_t *tx, uint8_t *rx, uint32_t size) {
+    spi_xchng_t *xchng = (spi_xchng_t *)xchng_buffer;
+    memcpy(xchng->data, tx, size);
+    int err = rpi_spi_exchange(BUS, DEVICE, xchng, size);
+    memcpy(rx, xchng->data, size);
+    return err;
+}
+
+// A driver that states its configuration before every transfer; only the first one is sent
+static int transfer_reconfigure(uint8_t *tx, uint8_t *rx, uint32_t size) {
+    rpi_spi_set_config(BUS, DEVICE, SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0, SPI_SPEED);
+    return rpi_spi_write_read_data(BUS, DEVICE, tx, rx, size);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Run one benchmark case and print its throughput
+static int run_case(const char *name, transfer_fn transfer, uint32_t size, int iterations) {
+    uint8_t tx[MAX_TRANSFER];
+    uint8_t rx[MAX_TRANSFER];
+
+    for (int i = 0; i < size; i++) {
+        tx[i] = (uint8_t)(i * 37 + 1);
+    }
+
+    // Check the loopback once so a broken path cannot post a good number
+    memset(rx, 0, sizeof(rx));
+    if (transfer(tx, rx, size) != 0) {
+        fprintf(stderr, "%s: transfer failed\n", name);
+        return -1;
+    }
+    if (transfer != transfer_write_only && memcmp(tx, rx, size) != 0) {
+        fprintf(stderr, "%s: read data does not match written data\n", name);
+        return -1;
+    }
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        if (transfer(tx, rx, size) != 0) {
+            fprintf(stderr, "%s: transfer failed\n", name);
+            return -1;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    printf("%-12s %4u bytes: %9.0f transfers/s  %7.2f us/transfer\n",
+           name, size, iterations * 1e9 / elapsed, elapsed / 1e3 / iterations);
+    return 0;
+}
+
+// Keep two asynchronous requests queued: one is sent while the next is prepared
+static int run_async_case(uint32_t size, int iterations) {
+    uint8_t tx[2][MAX_TRANSFER];
+    uint8_t rx[2][MAX_TRANSFER];
+    rpi_spi_segment_t segments[2];
+    rpi_spi_request_t requests[2];
+
+    for (int r = 0; r < 2; r++) {
+        segments[r] = (rpi_spi_segment_t){.tx = tx[r], .rx = rx[r], .len = size};
+        requests[r] = (rpi_spi_request_t){.device_number = DEVICE, .segments = &segments[r], .segment_count = 1};
+    }
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        rpi_spi_request_t *request = &requests[i % 2];
+
+        // Wait for the request submitted two iterations ago before refilling its buffer
+        if (i >= 2 && rpi_spi_wait(request) != SPI_SUCCESS) {
+            fprintf(stderr, "async: transfer failed\n");
+            return -1;
+        }
+        memset(tx[i % 2], i, size);
+
+        if (rpi_spi_submit(BUS, request) != SPI_SUCCESS) {
+            fprintf(stderr, "async: submit failed\n");
+            return -1;
+        }
+    }
+    for (int r = 0; r < 2 && r < iterations; r++) {
+        if (rpi_spi_wait(&requests[r]) != SPI_SUCCESS) {
+            fprintf(stderr, "async: transfer failed\n");
+            return -1;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    printf("%-12s %4u bytes: %9.0f transfers/s  %7.2f us/transfer\n",
+           "async", size, iterations * 1e9 / elapsed, elapsed / 1e3 / iterations);
+    return 0;
+}
+
+// Transfer lists with long write-only segments: sent whole when nothing is read after them,
+// refused before anything is sent when too much of them would have to be skipped ahead of a read
+static int run_long_segments(void) {
+    static uint8_t tx[LONG_SEGMENT + TAIL_READ];
+    uint8_t rx[TAIL_READ];
+    uint8_t first_rx[3];
+
+    for (int i = 0; i < sizeof(tx); i++) {
+        tx[i] = (uint8_t)(i * 37 + 1);
+    }
+
+    rpi_spi_segment_t write_only = {.tx = tx, .len = LONG_SEGMENT};
+    if (rpi_spi_transfer_list(BUS, DEVICE, &write_only, 1) != SPI_SUCCESS) {
+        fprintf(stderr, "long segments: %u-byte write-only segment failed\n", LONG_SEGMENT);
+        return -1;
+    }
+
+    // Within the limit, the data skipped ahead of the read must not shift it
+    rpi_spi_segment_t skip_then_read[2] = {
+        {.tx = tx, .len = 4096},
+        {.tx = tx + 4096, .rx = rx, .len = TAIL_READ},
+    };
+    memset(rx, 0, sizeof(rx));
+    if (rpi_spi_transfer_list(BUS, DEVICE, skip_then_read, 2) != SPI_SUCCESS || memcmp(rx, tx + 4096, TAIL_READ) != 0) {
+        fprintf(stderr, "long segments: read after 4096 skipped bytes failed\n");
+        return -1;
+    }
+
+    // The first run is valid, the second one is not: the list must be refused as a whole
+    rpi_spi_segment_t too_long[3] = {
+        {.tx = tx, .rx = first_rx, .len = sizeof(first_rx), .flags = SPI_SEGMENT_CS_DEASSERT},
+        {.tx = tx, .len = LONG_SEGMENT},
+        {.tx = tx + LONG_SEGMENT, .rx = rx, .len = TAIL_READ},
+    };
+    memset(first_rx, 0, sizeof(first_rx));
+    if (rpi_spi_transfer_list(BUS, DEVICE, too_long, 3) != SPI_ERROR_BAD_ARGUMENT) {
+        fprintf(stderr, "long segments: %u bytes skipped ahead of a read were not refused\n", LONG_SEGMENT);
+        return -1;
+    }
+    if (first_rx[0] != 0 || first_rx[1] != 0 || first_rx[2] != 0) {
+        fprintf(stderr, "long segments: part of a refused list was sent\n");
+        return -1;
+    }
+
+    printf("Long segments: %u bytes write-only sent, %u bytes ahead of a read refused\n", LONG_SEGMENT, LONG_SEGMENT);
+    return 0;
+}
+
+// Time rpi_spi_transfer() on one device with the current DMA threshold, in ns per transfer
+static double time_transfer(unsigned bus, unsigned device, rpi_spi_dma_buffer_t *buffer, uint32_t size, int iterations) {
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        if (rpi_spi_transfer(bus, device, buffer, size) != SPI_SUCCESS) {
+            return -1;
+        }
+    }
+    return (double)(now_ns() - start) / iterations;
+}
+
+// Compare message (PIO) and DMA exchanges over a range of sizes and report where DMA starts to win
+static int run_dma_sweep(unsigned bus, unsigned device, int iterations) {
+    spi_drvinfo_t info;
+    if (rpi_spi_get_driver_info(bus, device, &info) != SPI_SUCCESS || !(info.feature & SPI_FEATURE_DMA)) {
+        printf("\nspi%u/dev%u: the driver does not support DMA, skipping the crossover sweep\n", bus, device);
+        return 0;
+    }
+
+    rpi_spi_dma_buffer_t buffer;
+    if (rpi_spi_dma_alloc(&buffer, SWEEP_MAX) != SPI_SUCCESS) {
+        fprintf(stderr, "Failed to allocate DMA buffers\n");
+        return -1;
+    }
+    for (uint32_t i = 0; i < SWEEP_MAX; i++) {
+        buffer.tx[i] = (uint8_t)(i * 37 + 1);
+    }
+
+    printf("\nPIO vs DMA on spi%u/dev%u, %d transfers per size:\n", bus, device, iterations);
+
+    uint32_t crossover = 0;
+    int result = 0;
+    for (uint32_t size = SWEEP_MIN; size <= SWEEP_MAX; size *= 2) {
+        rpi_spi_set_dma_threshold(bus, device, RPI_SPI_DMA_NEVER);
+        double pio_ns = time_transfer(bus, device, &buffer, size, iterations);
+        rpi_spi_set_dma_threshold(bus, device, 0);
+        double dma_ns = time_transfer(bus, device, &buffer, size, iterations);
+
+        if (pio_ns < 0 || dma_ns < 0) {
+            fprintf(stderr, "%u bytes: transfer failed\n", size);
+            result = -1;
+            break;
+        }
+
+        printf("%5u bytes: PIO %8.2f us  DMA %8.2f us\n", size, pio_ns / 1e3, dma_ns / 1e3);
+
+        // The crossover is the smallest size from which DMA stays ahead
+        if (dma_ns < pio_ns) {
+            if (crossover == 0) {
+                crossover = size;
+            }
+        } else {
+            crossover = 0;
+        }
+    }
+
+    if (result == 0) {
+        if (crossover != 0) {
+            printf("DMA is faster from %u bytes: rpi_spi_set_dma_threshold(%u, %u, %u)\n", crossover, bus, device, crossover);
+        } else {
+            printf("DMA is not faster at any size up to %u bytes\n", SWEEP_MAX);
+        }
+    }
+
+    rpi_spi_set_dma_threshold(bus, device, crossover != 0 ? crossover : RPI_SPI_DMA_NEVER);
+    rpi_spi_dma_free(&buffer);
+    return result;
+}
+
+static atomic_bool arbitration_running;
+
+// Push full display frames back to back, one chip select pulse per row
+static void *display_thread(void *arg) {
+    static uint8_t rows[DISPLAY_ROWS][DISPLAY_ROW_BYTES];
+    rpi_spi_segment_t segments[DISPLAY_ROWS];
+
+    for (int r = 0; r < DISPLAY_ROWS; r++) {
+        segments[r] = (rpi_spi_segment_t){.tx = rows[r], .len = DISPLAY_ROW_BYTES, .flags = SPI_SEGMENT_CS_DEASSERT};
+    }
+
+    while (atomic_load(&arbitration_running)) {
+        rpi_spi_transfer_list(BUS, DISPLAY_DEVICE, segments, DISPLAY_ROWS);
+    }
+    return NULL;
+}
+
+// Read two ADC channels every period, each conversion in its own chip select pulse
+static void *adc_thread(void *arg) {
+    uint8_t tx[2][3] = {{0x01, 0x80, 0x00}, {0x01, 0x90, 0x00}};
+    uint8_t rx[2][3];
+    rpi_spi_segment_t segments[2] = {
+        {.tx = tx[0], .rx = rx[0], .len = 3, .flags = SPI_SEGMENT_CS_DEASSERT},
+        {.tx = tx[1], .rx = rx[1], .len = 3, .flags = SPI_SEGMENT_CS_DEASSERT},
+    };
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (atomic_load(&arbitration_running)) {
+        rpi_spi_transfer_list(BUS, ADC_DEVICE, segments, 2);
+
+        next.tv_nsec += ADC_PERIOD_NS;
+        if (next.tv_nsec >= 1000000000) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+static void print_latency(const char *name, rpi_spi_priority_t priority) {
+    rpi_spi_latency_stats_t stats;
+    rpi_spi_get_latency_stats(BUS, priority, &stats);
+    printf("%-8s %8llu exchanges  p50 %7.1f us  p90 %7.1f us  p99 %7.1f us  max %7.1f us\n",
+           name, (unsigned long long)stats.count, stats.p50_ns / 1e3, stats.p90_ns / 1e3,
+           stats.p99_ns / 1e3, stats.max_ns / 1e3);
+}
+
+// Run the display and the ADC against each other and report the wait of each class
+static int run_arbitration(void) {
+    const unsigned devices[] = {DISPLAY_DEVICE, ADC_DEVICE};
+
+    for (int d = 0; d < 2; d++) {
+        if (mock_spi_start(BUS, devices[d], MOCK_SPI_TIMED) != MOCK_SPI_SUCCESS ||
+            rpi_spi_configure_device(BUS, devices[d], SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0, SPI_SPEED) != SPI_SUCCESS) {
+            fprintf(stderr, "Failed to start the timed mock SPI devices\n");
+            return -1;
+        }
+    }
+
+    rpi_spi_set_priority(BUS, DISPLAY_DEVICE, SPI_PRIORITY_BULK);
+    rpi_spi_set_priority(BUS, ADC_DEVICE, SPI_PRIORITY_REALTIME);
+    rpi_spi_reset_latency_stats(BUS);
+
+    pthread_t display, adc;
+    atomic_store(&arbitration_running, true);
+    pthread_create(&display, NULL, display_thread, NULL);
+    pthread_create(&adc, NULL, adc_thread, NULL);
+
+    sleep(ARBITRATION_SECONDS);
+    atomic_store(&arbitration_running, false);
+    pthread_join(display, NULL);
+    pthread_join(adc, NULL);
+
+    printf("\nBus wait of a %d-byte display row stream and a 1 kHz ADC at %d Hz:\n",
+           DISPLAY_ROW_BYTES, SPI_SPEED);
+    print_latency("display", SPI_PRIORITY_BULK);
+    print_latency("adc", SPI_PRIORITY_REALTIME);
+
+    for (int d = 0; d < 2; d++) {
+        rpi_spi_cleanup_device(BUS, devices[d]);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0 || argc == 3 || argc > 4) {
+        fprintf(stderr, "usage: %s [iterations [bus device]]\n", argv[0]);
+        return 1;
+    }
+
+    // With a bus and device, only the DMA crossover is measured, on that (real) device
+    if (argc == 4) {
+        unsigned bus = atoi(argv[2]);
+        unsigned device = atoi(argv[3]);
+        if (rpi_spi_configure_device(bus, device, SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0, SPI_SPEED) != SPI_SUCCESS) {
+            fprintf(stderr, "Failed to configure spi%u/dev%u\n", bus, device);
+            return 1;
+        }
+        int failed = run_dma_sweep(bus, device, iterations);
+        rpi_spi_cleanup_device(bus, device);
+        return failed ? 1 : 0;
+    }
+
+    if (mock_spi_start(BUS, DEVICE, 0) != MOCK_SPI_SUCCESS) {
+        fprintf(stderr, "Failed to start the mock SPI device\n");
+        return 1;
+    }
+
+    if (rpi_spi_configure_device(BUS, DEVICE, SPI_MODE_BODER_MSB | SPI_MODE_WORD_WIDTH_8 | SPI_MODE_CPHA_0, SPI_SPEED) != SPI_SUCCESS) {
+        fprintf(stderr, "Failed to configure the mock SPI device\n");
+        return 1;
+    }
+
+    char path[32];
+    snprintf(path, sizeof(path), "/dev/io-spi/spi%d/dev%d", BUS, DEVICE);
+    legacy_fd = open(path, O_RDWR);
+    if (legacy_fd < 0) {
+        perror("open");
+        return 1;
+    }
+
+    // 2 bytes: a MAX7219 register write, 3 bytes: an MCP3008 conversion
+    const uint32_t sizes[] = {2, 3, MAX_TRANSFER};
+    int failed = 0;
+
+    printf("%d transfers per case against a loopback device\n", iterations);
+    for (int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        failed |= run_case("malloc+copy", transfer_legacy, sizes[s], iterations);
+        failed |= run_case("vectored", transfer_vectored, sizes[s], iterations);
+        failed |= run_case("write-only", transfer_write_only, sizes[s], iterations);
+        failed |= run_case("in-place", transfer_in_place, sizes[s], iterations);
+        failed |= run_case("set-config", transfer_reconfigure, sizes[s], iterations);
+        failed |= run_async_case(sizes[s], iterations);
+    }
+
+    rpi_spi_config_stats_t config_stats;
+    rpi_spi_get_config_stats(BUS, DEVICE, &config_stats);
+    printf("Configurations requested: %llu, sent to the driver: %llu\n",
+           (unsigned long long)config_stats.requests, (unsigned long long)config_stats.set_configs);
+
+    failed |= run_long_segments();
+    close(legacy_fd);
+
+    int sweep_iterations = iterations / 10 > 0 ? iterations / 10 : 1;
+    failed |= run_dma_sweep(BUS, DEVICE, sweep_iterations);
+    rpi_spi_cleanup_device(BUS, DEVICE);
+
+    failed |= run_arbitration();
+    return failed ? 1 : 0;
+}
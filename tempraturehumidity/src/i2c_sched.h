@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef I2C_SCHED_H
+#define I2C_SCHED_H
+
+#include <stdint.h>
+
+/* Return codes for client API */
+#define I2C_SCHED_SUCCESS 0
+#define I2C_SCHED_ERROR_BAD_ARGUMENT -1
+#define I2C_SCHED_ERROR_FULL -2
+#define I2C_SCHED_ERROR_RUNNING -3
+#define I2C_SCHED_ERROR_SETUP_FAILED -4
+#define I2C_SCHED_ERROR_THREAD -5
+
+/* Return value of fetch() when the read succeeded but produced no sample to publish */
+#define I2C_SCHED_SKIP 1
+
+/* Return value of fetch() when the result is not ready yet: fetch() is called again retry_us later */
+#define I2C_SCHED_RETRY 2
+
+#define I2C_SCHED_MAX_DEVICES 16 // total across all buses
+#define I2C_SCHED_MAX_VALUES  4  // values carried by one sample
+
+/* A timestamped sample produced by a device driver */
+typedef struct
+{
+    const char *name;                     // name of the device that produced the sample
+    uint64_t timestamp_ns;                // CLOCK_MONOTONIC time at which the result was read
+    int32_t value[I2C_SCHED_MAX_VALUES];  // driver defined values (units documented by the driver)
+    unsigned count;                       // number of valid entries in value[]
+} i2c_sched_sample_t;
+
+typedef struct i2c_sched_device i2c_sched_device_t;
+
+/*
+ * A device driver registered with the scheduler.
+ *
+ * The scheduler calls trigger() to start a conversion, waits conversion_us
+ * while other devices use the bus, then calls fetch() to read the result.
+ * Devices that convert continuously on their own leave trigger NULL; they are
+ * fetched once per period, the first time conversion_us after setup().
+ * A driver may change period_us and conversion_us from its own callbacks,
+ * e.g. after changing the sensor resolution. A fetch() that returns
+ * I2C_SCHED_RETRY leaves the bus to the other devices until it is called
+ * again; the driver bounds the number of retries, and the period stays on
+ * its original grid.
+ */
+struct i2c_sched_device
+{
+    const char *name;        // device name, copied into every sample
+    unsigned bus;            // I2C bus number
+    uint8_t address;         // I2C address
+    uint32_t period_us;      // sampling period
+    uint32_t conversion_us;  // time between trigger() and the result being available
+    uint32_t retry_us;       // time between a fetch() returning I2C_SCHED_RETRY and the next one
+
+    int (*setup)(i2c_sched_device_t *dev);                                // optional, called once on start
+    int (*trigger)(i2c_sched_device_t *dev);                              // optional, starts a conversion
+    int (*fetch)(i2c_sched_device_t *dev, i2c_sched_sample_t *sample);    // reads the result (or I2C_SCHED_SKIP/RETRY)
+
+    void *priv;              // driver private data
+};
+
+/* Per-bus scheduler statistics */
+typedef struct
+{
+    uint64_t samples;        // samples published
+    uint64_t errors;         // failed trigger() or fetch() calls
+    uint64_t overruns;       // periods skipped because the bus could not keep up
+    uint64_t busy_ns;        // time spent inside bus transactions
+    uint64_t elapsed_ns;     // time since the scheduler started
+} i2c_sched_stats_t;
+
+/* Callback invoked from the bus thread for every sample */
+typedef void (*i2c_sched_callback_t)(const i2c_sched_sample_t *sample, void *arg);
+
+/**
+ * Register a device with the scheduler. Must be called before i2c_sched_start().
+ * The device structure must remain valid until i2c_sched_stop() returns.
+ *
+ * @param    dev     device driver description
+ *
+ * @returns  I2C_SCHED_SUCCESS             on success,
+ *           I2C_SCHED_ERROR_BAD_ARGUMENT  missing fetch() callback, zero period or invalid bus
+ *           I2C_SCHED_ERROR_FULL          I2C_SCHED_MAX_DEVICES already registered
+ *           I2C_SCHED_ERROR_RUNNING       the scheduler is already running
+ */
+int i2c_sched_add_device(i2c_sched_device_t *dev);
+
+/**
+ * Run setup() for every device and start one sampling thread per bus in use.
+ * The bus threads block SIGINT and SIGTERM, which are left to the threads of
+ * the application (e.g. one waiting in pause()).
+ *
+ * @param    callback  function receiving every published sample
+ * @param    arg       user argument passed to the callback
+ *
+ * @returns  I2C_SCHED_SUCCESS             on success,
+ *           I2C_SCHED_ERROR_BAD_ARGUMENT  no callback provided
+ *           I2C_SCHED_ERROR_RUNNING       the scheduler is already running
+ *           I2C_SCHED_ERROR_SETUP_FAILED  a device setup() failed
+ *           I2C_SCHED_ERROR_THREAD        a bus thread could not be created
+ */
+int i2c_sched_start(i2c_sched_callback_t callback, void *arg);
+
+/**
+ * Stop all bus threads and forget the registered devices
+ *
+ * @returns  I2C_SCHED_SUCCESS             on success
+ */
+int i2c_sched_stop(void);
+
+/**
+ * Read the statistics of a bus
+ *
+ * @param    bus_number  I2C bus number
+ * @param    stats       statistics (output)
+ *
+ * @returns  I2C_SCHED_SUCCESS             on success,
+ *           I2C_SCHED_ERROR_BAD_ARGUMENT  invalid bus number or stats pointer
+ */
+int i2c_sched_get_stats(unsigned bus_number, i2c_sched_stats_t *stats);
+
+#endif
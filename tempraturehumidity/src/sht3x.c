@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include "rpi_i2c.h"
+#include "sht3x.h"
+
+#define SHT3X_RETRY_DELAY_US 1000 // give a late measurement time to complete before fetching again
+
+static const uint8_t SHT3X_BREAK_CMD[]  = {0x30, 0x93}; // Stop periodic acquisition
+static const uint8_t SHT3X_SRESET_CMD[] = {0x30, 0xA2}; // Soft reset
+static const uint8_t SHT3X_FETCH_CMD[]  = {0xE0, 0x00}; // Fetch periodic measurement data
+
+// Periodic acquisition commands, indexed by [rate][repeatability]
+static const uint8_t SHT3X_PERIODIC_CMD[][3][2] = {
+    {{0x20, 0x32}, {0x20, 0x24}, {0x20, 0x2F}},  // 0.5 mps
+    {{0x21, 0x30}, {0x21, 0x26}, {0x21, 0x2D}},  // 1 mps
+    {{0x22, 0x36}, {0x22, 0x20}, {0x22, 0x2B}},  // 2 mps
+    {{0x23, 0x34}, {0x23, 0x22}, {0x23, 0x29}},  // 4 mps
+    {{0x27, 0x37}, {0x27, 0x21}, {0x27, 0x2A}},  // 10 mps
+};
+
+// Measurement period for each rate
+static const uint32_t SHT3X_PERIOD_US[] = {2000000, 1000000, 500000, 250000, 100000};
+
+// Maximum measurement duration for each repeatability
+static const uint32_t SHT3X_MEASURE_US[] = {15500, 6500, 4500};
+
+// CRC-8 lookup table for polynomial 0x31
+static const uint8_t SHT3X_CRC8_TABLE[256] = {
+    0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97,
+    0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+    0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4,
+    0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+    0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11,
+    0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+    0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52,
+    0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+    0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA,
+    0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+    0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9,
+    0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+    0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C,
+    0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+    0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F,
+    0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+    0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED,
+    0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+    0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE,
+    0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+    0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B,
+    0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+    0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28,
+    0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+    0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0,
+    0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+    0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93,
+    0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+    0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56,
+    0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+    0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15,
+    0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC,
+};
+
+uint8_t sht3x_crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0xFF;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = SHT3X_CRC8_TABLE[crc ^ data[i]];
+    }
+
+    return crc;
+}
+
+/* Send a two byte command */
+static int sht3x_command(sht3x_t *sensor, const uint8_t *cmd)
+{
+    if (smbus_write_block(sensor->bus, sensor->address, cmd, 2) != I2C_SUCCESS)
+    {
+        return SHT3X_ERROR_OPERATION_FAILED;
+    }
+
+    return SHT3X_SUCCESS;
+}
+
+int sht3x_reset(sht3x_t *sensor)
+{
+    if (sensor == NULL)
+    {
+        return SHT3X_ERROR_BAD_ARGUMENT;
+    }
+
+    if (sht3x_command(sensor, SHT3X_BREAK_CMD) != SHT3X_SUCCESS)
+    {
+        return SHT3X_ERROR_OPERATION_FAILED;
+    }
+
+    usleep(1000);  // Break takes up to 1 ms
+
+    if (sht3x_command(sensor, SHT3X_SRESET_CMD) != SHT3X_SUCCESS)
+    {
+        return SHT3X_ERROR_OPERATION_FAILED;
+    }
+
+    usleep(1500);  // Soft reset takes up to 1.5 ms
+
+    return SHT3X_SUCCESS;
+}
+
+int sht3x_start_periodic(sht3x_t *sensor)
+{
+    if (sensor == NULL || sensor->rate > SHT3X_MPS_10 || sensor->repeatability > SHT3X_REPEATABILITY_LOW)
+    {
+        return SHT3X_ERROR_BAD_ARGUMENT;
+    }
+
+    return sht3x_command(sensor, SHT3X_PERIODIC_CMD[sensor->rate][sensor->repeatability]);
+}
+
+int sht3x_stop_periodic(sht3x_t *sensor)
+{
+    if (sensor == NULL)
+    {
+        return SHT3X_ERROR_BAD_ARGUMENT;
+    }
+
+    int status = sht3x_command(sensor, SHT3X_BREAK_CMD);
+    usleep(1000);
+
+    return status;
+}
+
+/* Send Fetch Data and validate the returned words; no retries */
+static int sht3x_fetch_once(sht3x_t *sensor, uint16_t *raw_temperature, uint16_t *raw_humidity)
+{
+    uint8_t data[6];
+
+    // temp (2 bytes) + CRC (1), humidity (2 bytes) + CRC (1); the read is NACKed if no new data is available
+    if (sht3x_command(sensor, SHT3X_FETCH_CMD) != SHT3X_SUCCESS ||
+        smbus_read_block(sensor->bus, sensor->address, data, sizeof(data)) != I2C_SUCCESS)
+    {
+        return SHT3X_ERROR_OPERATION_FAILED;
+    }
+
+    if (sht3x_crc8(&data[0], 2) != data[2] || sht3x_crc8(&data[3], 2) != data[5])
+    {
+        sensor->crc_errors++;
+        return SHT3X_ERROR_CRC;
+    }
+
+    *raw_temperature = (data[0] << 8) | data[1];
+    *raw_humidity = (data[3] << 8) | data[4];
+
+    return SHT3X_SUCCESS;
+}
+
+/* Fetch and convert one measurement; no retries */
+static int sht3x_read(sht3x_t *sensor, int32_t *temperature_mc, int32_t *humidity_mrh)
+{
+    uint16_t raw_temperature, raw_humidity;
+    int status = sht3x_fetch_once(sensor, &raw_temperature, &raw_humidity);
+    if (status != SHT3X_SUCCESS)
+    {
+        return status;
+    }
+
+    // T = -45 + 175 * raw / (2^16 - 1), RH = 100 * raw / (2^16 - 1)
+    *temperature_mc = -45000 + (int32_t)((175000LL * raw_temperature) / 65535);
+    *humidity_mrh = (int32_t)((100000LL * raw_humidity) / 65535);
+
+    return SHT3X_SUCCESS;
+}
+
+int sht3x_fetch(sht3x_t *sensor, int32_t *temperature_mc, int32_t *humidity_mrh)
+{
+    if (sensor == NULL || temperature_mc == NULL || humidity_mrh == NULL)
+    {
+        return SHT3X_ERROR_BAD_ARGUMENT;
+    }
+
+    int status = sht3x_read(sensor, temperature_mc, humidity_mrh);
+
+    for (unsigned attempt = 0; status != SHT3X_SUCCESS && attempt < sensor->retries; attempt++)
+    {
+        usleep(SHT3X_RETRY_DELAY_US);
+        status = sht3x_read(sensor, temperature_mc, humidity_mrh);
+    }
+
+    return status;
+}
+
+uint32_t sht3x_period_us(const sht3x_t *sensor)
+{
+    return SHT3X_PERIOD_US[sensor->rate];
+}
+
+uint32_t sht3x_measurement_time_us(const sht3x_t *sensor)
+{
+    return SHT3X_MEASURE_US[sensor->repeatability];
+}
+
+static int sched_setup(i2c_sched_device_t *dev)
+{
+    sht3x_t *sensor = dev->priv;
+
+    if (sht3x_reset(sensor) != SHT3X_SUCCESS || sht3x_start_periodic(sensor) != SHT3X_SUCCESS)
+    {
+        fprintf(stderr, "SHT3X: Failed to start periodic acquisition\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int sched_fetch(i2c_sched_device_t *dev, i2c_sched_sample_t *sample)
+{
+    sht3x_t *sensor = dev->priv;
+
+    int status = sht3x_read(sensor, &sample->value[0], &sample->value[1]);
+    if (status != SHT3X_SUCCESS && sensor->attempts < sensor->retries)
+    {
+        // Fetched again after SHT3X_RETRY_DELAY_US, without keeping the other devices off the bus
+        sensor->attempts++;
+        return I2C_SCHED_RETRY;
+    }
+
+    sensor->attempts = 0;
+    if (status != SHT3X_SUCCESS)
+    {
+        fprintf(stderr, "SHT3X: Failed to fetch data (%d)\n", status);
+        return -1;
+    }
+
+    sample->count = 2;
+    return 0;
+}
+
+void sht3x_sched_device_init(sht3x_t *sensor, i2c_sched_device_t *dev, const char *name)
+{
+    *dev = (i2c_sched_device_t){
+        .name = name,
+        .bus = sensor->bus,
+        .address = sensor->address,
+        .period_us = sht3x_period_us(sensor),
+        .conversion_us = sht3x_measurement_time_us(sensor),
+        .retry_us = SHT3X_RETRY_DELAY_US,
+        .setup = sched_setup,
+        .fetch = sched_fetch,
+        .priv = sensor};
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2025, BlackBerry Limited. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SHT3X_H
+#define SHT3X_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "i2c_sched.h"
+
+/* Return codes for client API */
+#define SHT3X_SUCCESS 0
+#define SHT3X_ERROR_BAD_ARGUMENT -1
+#define SHT3X_ERROR_OPERATION_FAILED -2
+#define SHT3X_ERROR_CRC -3
+
+#define SHT3X_DEFAULT_RETRIES 3
+
+/* Measurement repeatability: higher repeatability takes longer to measure */
+typedef enum
+{
+    SHT3X_REPEATABILITY_HIGH,
+    SHT3X_REPEATABILITY_MEDIUM,
+    SHT3X_REPEATABILITY_LOW
+} sht3x_repeatability_t;
+
+/* Periodic acquisition rate in measurements per second */
+typedef enum
+{
+    SHT3X_MPS_0_5,
+    SHT3X_MPS_1,
+    SHT3X_MPS_2,
+    SHT3X_MPS_4,
+    SHT3X_MPS_10
+} sht3x_rate_t;
+
+/* A SHT3x sensor running in periodic acquisition mode */
+typedef struct
+{
+    unsigned bus;                          // I2C bus number
+    uint8_t address;                       // I2C address (0x44 or 0x45)
+    sht3x_rate_t rate;                     // measurements per second
+    sht3x_repeatability_t repeatability;   // measurement repeatability
+    unsigned retries;                      // extra fetch attempts after a NACK or CRC error
+    uint32_t crc_errors;                   // number of words rejected by the CRC check
+    unsigned attempts;                     // failed fetches of the current measurement, when scheduled
+} sht3x_t;
+
+/**
+ * Calculate the SHT3x CRC-8 (polynomial 0x31, initial value 0xFF) of a buffer
+ *
+ * @param    data    data bytes
+ * @param    len     number of bytes
+ *
+ * @returns  the CRC-8 of the data
+ */
+uint8_t sht3x_crc8(const uint8_t *data, size_t len);
+
+/**
+ * Stop any running acquisition and soft reset the sensor
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  SHT3X_SUCCESS                 on success,
+ *           SHT3X_ERROR_BAD_ARGUMENT      invalid sensor pointer
+ *           SHT3X_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int sht3x_reset(sht3x_t *sensor);
+
+/**
+ * Start periodic acquisition at the configured rate and repeatability
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  SHT3X_SUCCESS                 on success,
+ *           SHT3X_ERROR_BAD_ARGUMENT      invalid sensor pointer, rate or repeatability
+ *           SHT3X_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int sht3x_start_periodic(sht3x_t *sensor);
+
+/**
+ * Stop periodic acquisition (break command)
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  SHT3X_SUCCESS                 on success,
+ *           SHT3X_ERROR_BAD_ARGUMENT      invalid sensor pointer
+ *           SHT3X_ERROR_OPERATION_FAILED  I2C operation failed
+ */
+int sht3x_stop_periodic(sht3x_t *sensor);
+
+/**
+ * Fetch the latest periodic measurement. Both words are CRC checked; a
+ * corrupt or missing measurement is fetched again up to sensor->retries times,
+ * sleeping in between. The scheduler device of sht3x_sched_device_init()
+ * retries through the scheduler instead, without holding the bus thread.
+ *
+ * @param    sensor          sensor description
+ * @param    temperature_mc  temperature in milli degrees Celsius (output)
+ * @param    humidity_mrh    relative humidity in milli percent (output)
+ *
+ * @returns  SHT3X_SUCCESS                 on success,
+ *           SHT3X_ERROR_BAD_ARGUMENT      invalid pointer
+ *           SHT3X_ERROR_OPERATION_FAILED  I2C operation failed (e.g. no new data)
+ *           SHT3X_ERROR_CRC               the data failed the CRC check
+ */
+int sht3x_fetch(sht3x_t *sensor, int32_t *temperature_mc, int32_t *humidity_mrh);
+
+/**
+ * Time between two periodic measurements
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  the measurement period in microseconds
+ */
+uint32_t sht3x_period_us(const sht3x_t *sensor);
+
+/**
+ * Time needed for a single measurement at the configured repeatability
+ *
+ * @param    sensor  sensor description
+ *
+ * @returns  the maximum measurement duration in microseconds
+ */
+uint32_t sht3x_measurement_time_us(const sht3x_t *sensor);
+
+/**
+ * Describe the sensor to the I2C sampling scheduler. The sensor is put into
+ * periodic mode by the scheduler and fetched once per measurement period;
+ * samples carry the temperature (value[0], milli degrees Celsius) and the
+ * relative humidity (value[1], milli percent).
+ *
+ * @param    sensor  sensor description, must outlive the scheduler
+ * @param    dev     scheduler device (output)
+ * @param    name    device name used in samples
+ */
+void sht3x_sched_device_init(sht3x_t *sensor, i2c_sched_device_t *dev, const char *name);
+
+#endif
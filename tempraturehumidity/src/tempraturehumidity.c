@@ -16,9 +16,10 @@
 
 #include <stdio.h>      // For standard input/output functions
 #include <stdint.h>     // For fixed-size integer types like uint8_t, uint16_t
-#include <string.h>     // For memory functions if needed
-#include <unistd.h>     // For usleep()
+#include <unistd.h>     // For pause()
 #include "rpi_i2c.h"    // I2C abstraction for QNX platform
+#include "i2c_sched.h"  // Periodic sampling scheduler for I2C sensors
+#include "sht3x.h"      // SHT3X temperature/humidity sensor driver
 #include <stdbool.h>    // For using `bool`, `true`, `false`
 #include <signal.h>     // For handling termination signals like Ctrl+C
 
@@ -26,77 +27,13 @@
 #define SHT3X_ADDR 0x44  // Default I2C address for the SHT3X temperature/humidity sensor
 #define BUS 1            // I2C bus number (usually bus 1 on Raspberry Pi)
 
-// I2C commands for SHT3X sensor
-const uint8_t SHT3X_BREAK_CMD[]   = {0x30, 0x93}; // Soft reset "break" command
-const uint8_t SHT3X_SRESET_CMD[]  = {0x30, 0xA2}; // Software reset command
-const uint8_t SHT3X_MEASURE_CMD[] = {0x2C, 0x06}; // High repeatability, no clock stretching
-
-// Struct to hold sensor data
-typedef struct {
-    float temperature;
-    float humidity;
-    int valid;  // 1 if data is valid, 0 if error occurred
-} SHT3XData;
-
 // Global flag to control the main loop; allows clean exit on signal
 bool running = true;
 
-// Initialize the SHT3X sensor by sending soft reset commands
-int sht3x_init() {
-    // Send "break" command to reset the sensor
-    if (smbus_write_block(BUS, SHT3X_ADDR, SHT3X_BREAK_CMD, sizeof(SHT3X_BREAK_CMD)) != I2C_SUCCESS) {
-        printf("SHT3X-1: Failed to initialize sensor\n");
-        return -1;
-    }
-
-    usleep(1000);  // Wait briefly after reset
-
-    // Send software reset command
-    if (smbus_write_block(BUS, SHT3X_ADDR, SHT3X_SRESET_CMD, sizeof(SHT3X_SRESET_CMD)) != I2C_SUCCESS) {
-        printf("SHT3X-2: Failed to initialize sensor\n");
-        return -1;
-    }
-
-    usleep(1000);  // Wait briefly again
-
-    return 0;  // Success
-}
-
-// Read data from the SHT3X sensor and return it in a SHT3XData struct
-SHT3XData sht3x_read() {
-    SHT3XData data = {0};         // Initialize all fields to 0
-    uint8_t rawData[6] = {0};     // Buffer to hold raw sensor output
-
-    // Request a single-shot measurement
-    if (smbus_write_block(BUS, SHT3X_ADDR, SHT3X_MEASURE_CMD, sizeof(SHT3X_MEASURE_CMD)) != I2C_SUCCESS) {
-        printf("SHT3X: Failed to send measure command\n");
-        data.valid = 0;
-        return data;
-    }
-
-    usleep(15000);  // Wait 15 milliseconds for measurement to complete
-
-    // Read 6 bytes: temp (2 bytes) + CRC (1), humidity (2 bytes) + CRC (1)
-    if (smbus_read_block(BUS, SHT3X_ADDR, rawData, sizeof(rawData)) != I2C_SUCCESS) {
-        printf("SHT3X: Failed to read data\n");
-        data.valid = 0;
-        return data;
-    }
-
-    // Convert temperature: bytes 0 and 1
-    uint16_t rawTemp = (rawData[0] << 8) | rawData[1];
-    float temperature = -45.0f + 175.0f * (float)rawTemp / 65535.0f;
-
-    // Convert humidity: bytes 3 and 4
-    uint16_t rawHumidity = (rawData[3] << 8) | rawData[4];
-    float humidity = 100.0f * (float)rawHumidity / 65535.0f;
-
-    // Store results
-    data.temperature = temperature;
-    data.humidity = humidity;
-    data.valid = 1;  // Mark data as valid
-
-    return data;
+// Prints every sample published by the scheduler
+static void print_sample(const i2c_sched_sample_t *sample, void *arg) {
+    (void)(arg);
+    printf("Temp: %.2f°C, Humidity: %.2f%%\n", sample->value[0] / 1000.0f, sample->value[1] / 1000.0f);
 }
 
 // Signal handler to stop the main loop cleanly
@@ -117,25 +54,39 @@ static void setup_handlers(void) {
 // Main application entry point
 int main() {
 
-    // Initialize the sensor
-    if (sht3x_init() != 0) {
-        return -1;
-    }
-
     // Register signal handlers
     setup_handlers();
 
-    // Main loop: read and print sensor values until interrupted
+    // Two high repeatability measurements per second, fetched as they complete
+    sht3x_t sensor = {
+        .bus = BUS,
+        .address = SHT3X_ADDR,
+        .rate = SHT3X_MPS_2,
+        .repeatability = SHT3X_REPEATABILITY_HIGH,
+        .retries = SHT3X_DEFAULT_RETRIES,
+    };
+
+    i2c_sched_device_t sht3x;
+    sht3x_sched_device_init(&sensor, &sht3x, "sht3x");
+
+    if (i2c_sched_add_device(&sht3x) != I2C_SCHED_SUCCESS ||
+        i2c_sched_start(print_sample, NULL) != I2C_SCHED_SUCCESS) {
+        printf("SHT3X: Failed to start sampling\n");
+        smbus_cleanup(BUS);
+        return -1;
+    }
+
+    // Readings are printed from the scheduler thread until interrupted
     while (running) {
-        SHT3XData reading = sht3x_read();
+        pause();
+    }
 
-        if (!reading.valid) {
-            printf("SHT3X: Failed to get valid reading\n");
-        } else {
-            printf("Temp: %.2f°C, Humidity: %.2f%%\n", reading.temperature, reading.humidity);
-        }
+    i2c_sched_stop();
 
-        usleep(500000); // Wait 500 ms before next reading
+    // Return the sensor to idle mode
+    sht3x_stop_periodic(&sensor);
+    if (sensor.crc_errors) {
+        printf("SHT3X: %u readings failed the CRC check\n", sensor.crc_errors);
     }
 
     // Clean up I2C resources